@@ -0,0 +1,330 @@
+/*
+ * badblock.c
+ *
+ * Logical NAND addressing that skips bad blocks the way nandwrite does:
+ * logical block N of a partition is its N-th good block. The good blocks
+ * are a bitmap with the count of good blocks before every word (rank) and
+ * the word of every 64th good block (select samples), so a logical block
+ * is found with a table lookup and a popcount instead of a rescan. Reads,
+ * writes and erases are cut at the bad blocks only, a run of good blocks
+ * goes to the driver in one call.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "badblock.h"
+#include "timer.h"
+
+#define BB_SAMPLE	64	/* good blocks per select sample */
+#define BB_MAGIC	"# SNANDer bad block table"
+
+static struct {
+	struct flash_cmd *cmd;
+	struct flash_cmd orig;
+	unsigned long erase;		/* block size */
+	unsigned long blocks, nwords;
+	uint64_t *good;			/* 1 - good block */
+	uint32_t *rank;			/* good blocks before each word, nwords + 1 */
+	uint32_t *select;		/* word of every BB_SAMPLE-th good block */
+	unsigned long first, last;	/* partition blocks, last exclusive */
+	unsigned long base;		/* good blocks before the partition */
+	unsigned long long size;	/* logical bytes */
+} bb;
+
+static int bb_good(unsigned long b)
+{
+	return b < bb.blocks && (bb.good[b / 64] >> (b % 64)) & 1;
+}
+
+/* Good blocks before block b */
+static unsigned long bb_rank(unsigned long b)
+{
+	unsigned long w = b / 64;
+
+	return bb.rank[w] + (b % 64 ? __builtin_popcountll(bb.good[w] << (64 - b % 64)) : 0);
+}
+
+/* Block number of the k-th good block, k counts from 0 */
+static unsigned long bb_select(unsigned long k)
+{
+	unsigned long w = bb.select[k / BB_SAMPLE];
+	uint64_t bits;
+
+	while (bb.rank[w + 1] <= k)
+		w++;
+	for (bits = bb.good[w], k -= bb.rank[w]; k; k--)
+		bits &= bits - 1;
+	return w * 64 + __builtin_ctzll(bits);
+}
+
+static int bb_index(void)
+{
+	unsigned long w, s, r, c;
+
+	bb.rank = malloc((bb.nwords + 1) * sizeof(*bb.rank));
+	bb.select = malloc((bb.blocks / BB_SAMPLE + 1) * sizeof(*bb.select));
+	if (!bb.rank || !bb.select)
+		return -1;
+	for (w = 0, r = 0; w < bb.nwords; w++) {
+		bb.rank[w] = r;
+		c = __builtin_popcountll(bb.good[w]);
+		for (s = (r + BB_SAMPLE - 1) / BB_SAMPLE; s * BB_SAMPLE < r + c; s++)
+			bb.select[s] = w;
+		r += c;
+	}
+	bb.rank[w] = r;
+	return 0;
+}
+
+/* Bad block numbers one per line after the header with the chip */
+static int bb_load(const char *table, const char *name)
+{
+	char line[128], chip[96];
+	unsigned long n, b;
+	FILE *fp;
+
+	if (!(fp = fopen(table, "r")))
+		return -1;
+	if (!fgets(line, sizeof(line), fp) ||
+	    sscanf(line, BB_MAGIC " %lu %95[^\r\n]", &n, chip) != 2 ||
+	    n != bb.blocks || strcmp(chip, name)) {
+		printf("Bad block table %s is not for this chip.\n", table);
+		fclose(fp);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), fp))
+		if (*line != '#' && sscanf(line, "%lu", &b) == 1 && b < bb.blocks)
+			bb.good[b / 64] &= ~(1ULL << (b % 64));
+	fclose(fp);
+	printf("Bad block table %s loaded.\n", table);
+	return 0;
+}
+
+static void bb_save(const char *table, const char *name)
+{
+	unsigned long b;
+	FILE *fp;
+
+	if (!(fp = fopen(table, "w"))) {
+		printf("Couldn't open file %s for writing.\n", table);
+		return;
+	}
+	fprintf(fp, BB_MAGIC " %lu %s\n", bb.blocks, name);
+	for (b = 0; b < bb.blocks; b++)
+		if (!bb_good(b))
+			fprintf(fp, "%lu\n", b);
+	if (ferror(fp))
+		printf("Error writing file [%s]\n", table);
+	fclose(fp);
+}
+
+/* One page read per block for its marker */
+static int bb_scan(unsigned long from, unsigned long to)
+{
+	unsigned long b;
+	int r;
+
+	timer_start();
+	for (b = from; b < to; b++) {
+		if ((r = snand_block_bad(b)) < 0) {
+			printf("Bad block marker read failed in block %lu\n", b);
+			return -1;
+		}
+		if (r)
+			bb.good[b / 64] &= ~(1ULL << (b % 64));
+		if (timer_progress()) {
+			printf("\bBad block scan %d%% [%lu] of [%lu] blocks      ", timer_percent(b - from + 1, to - from), b - from + 1, to - from);
+			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+			fflush(stdout);
+		}
+	}
+	printf("Bad block scan 100%% [%lu] of [%lu] blocks      \n", to - from, to - from);
+	timer_end();
+	return 0;
+}
+
+/* Chip address of logical from and the bytes after it on consecutive good blocks */
+static unsigned long long bb_run(unsigned long long from, unsigned long long len, unsigned long long *phys)
+{
+	unsigned long b = bb_select(bb.base + from / bb.erase);
+	unsigned long long n = bb.erase - from % bb.erase;
+
+	*phys = (unsigned long long)b * bb.erase + from % bb.erase;
+	while (n < len && b + 1 < bb.last && bb_good(b + 1)) {
+		b++;
+		n += bb.erase;
+	}
+	return n < len ? n : len;
+}
+
+static int bb_range(const char *what, unsigned long long from, unsigned long long len)
+{
+	if (from > bb.size || len > bb.size - from) {
+		printf("%s 0x%llX bytes at 0x%016llX is past the good blocks of the partition\n", what, len, from);
+		return -1;
+	}
+	return 0;
+}
+
+static long long bb_read(unsigned char *buf, unsigned long long from, unsigned long long len)
+{
+	unsigned long long done, n, phys;
+
+	if (bb_range("Read", from, len) < 0)
+		return -1;
+	for (done = 0; done < len; done += n) {
+		n = bb_run(from + done, len - done, &phys);
+		if (bb.orig.flash_read(buf + done, phys, n) < 0)
+			return -1;
+	}
+	return len;
+}
+
+static long long bb_write(unsigned char *buf, unsigned long long to, unsigned long long len)
+{
+	unsigned long long done, n, phys;
+
+	if (bb_range("Write", to, len) < 0)
+		return -1;
+	for (done = 0; done < len; done += n) {
+		n = bb_run(to + done, len - done, &phys);
+		if (bb.orig.flash_write(buf + done, phys, n) < 0)
+			return -1;
+	}
+	return len;
+}
+
+static int bb_erase(unsigned long long offs, unsigned long long len)
+{
+	unsigned long long done, n, phys;
+
+	if (bb_range("Erase", offs, len) < 0)
+		return -1;
+	for (done = 0; done < len; done += n) {
+		n = bb_run(offs + done, len - done, &phys);
+		if (bb.orig.flash_erase(phys, n) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+static void bb_free(void)
+{
+	free(bb.good);
+	free(bb.rank);
+	free(bb.select);
+	memset(&bb, 0, sizeof(bb));
+}
+
+int bb_attach(struct flash_cmd *cmd, const char *part, const char *table, long long *flen)
+{
+	unsigned long long addr = 0, len = *flen, reserve = 0;
+	unsigned long b, bad;
+	struct flash_info info;
+	char *end;
+	int has_reserve = 0;
+
+	memset(&bb, 0, sizeof(bb));
+	cmd->flash_info(&info);
+	bb.erase = info.erase_size;
+	bb.blocks = *flen / bb.erase;
+
+	if (part) {
+		addr = strtoull(part, &end, 0);
+		if (*end == ':')
+			len = strtoull(end + 1, &end, 0);
+		if (*end == ':') {
+			reserve = strtoull(end + 1, &end, 0);
+			has_reserve = 1;
+		}
+		if (*end || part == end) {
+			printf("Partition %s is not <addr>:<len>[:<reserve>]\n", part);
+			return -1;
+		}
+	}
+	if (addr % bb.erase || len % bb.erase || !len || addr > *flen || len > *flen - addr) {
+		printf("Partition 0x%llX:0x%llX must be whole blocks of 0x%lX bytes inside the chip\n", addr, len, bb.erase);
+		return -1;
+	}
+	bb.first = addr / bb.erase;
+	bb.last = bb.first + len / bb.erase;
+	if (reserve >= bb.last - bb.first) {
+		printf("Reserve of %llu blocks leaves nothing of the partition\n", reserve);
+		return -1;
+	}
+
+	bb.nwords = (bb.blocks + 63) / 64;
+	if (!(bb.good = malloc(bb.nwords * sizeof(*bb.good)))) {
+		printf("Malloc failed for bad block table.\n");
+		return -1;
+	}
+	memset(bb.good, 0xff, bb.nwords * sizeof(*bb.good));
+	if (bb.blocks % 64)
+		bb.good[bb.nwords - 1] = (1ULL << (bb.blocks % 64)) - 1;
+
+	/* A table is kept for the whole chip, without one the partition is enough */
+	if (!table || bb_load(table, info.name) < 0) {
+		if (bb_scan(table ? 0 : bb.first, table ? bb.blocks : bb.last) < 0) {
+			bb_free();
+			return -1;
+		}
+		if (table)
+			bb_save(table, info.name);
+	}
+	if (bb_index() < 0) {
+		printf("Malloc failed for bad block table.\n");
+		bb_free();
+		return -1;
+	}
+
+	bb.base = bb_rank(bb.first);
+	bad = bb.last - bb.first - (bb_rank(bb.last) - bb.base);
+	for (b = bb.first; b < bb.last; b++)
+		if (!bb_good(b))
+			printf("Bad block %lu (0x%08llX)\n", b, (unsigned long long)b * bb.erase);
+	if (has_reserve && bad > reserve) {
+		printf("Partition has %lu bad blocks, more than its reserve of %llu\n", bad, reserve);
+		bb_free();
+		return -1;
+	}
+	if (bad == bb.last - bb.first) {
+		printf("Partition has no good blocks\n");
+		bb_free();
+		return -1;
+	}
+	bb.size = (unsigned long long)(bb.last - bb.first - (has_reserve ? reserve : bad)) * bb.erase;
+	printf("Skip bad blocks: partition 0x%llX, %lu blocks, %lu bad, logical size 0x%llX\n",
+		addr, bb.last - bb.first, bad, bb.size);
+
+	bb.cmd = cmd;
+	bb.orig = *cmd;
+	cmd->flash_read = bb_read;
+	cmd->flash_write = bb_write;
+	cmd->flash_erase = bb_erase;
+	*flen = bb.size;
+	return 0;
+}
+
+void bb_detach(void)
+{
+	if (!bb.cmd)
+		return;
+	bb.cmd->flash_read = bb.orig.flash_read;
+	bb.cmd->flash_write = bb.orig.flash_write;
+	bb.cmd->flash_erase = bb.orig.flash_erase;
+	bb_free();
+}
+/* End of [badblock.c] package */
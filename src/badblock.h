@@ -0,0 +1,32 @@
+/*
+ * badblock.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __BADBLOCK_H__
+#define __BADBLOCK_H__
+
+#include "flashcmd_api.h"
+
+/*
+ * Route the callbacks of cmd through logical addresses of the partition
+ * <addr>:<len>[:<reserve>] (NULL - whole chip), logical block N is the
+ * N-th good block of it. The bad blocks come from the table file when it
+ * matches the chip, else from the OOB markers and the table is saved.
+ * *flen is set to the logical size. Returns 0 or -1.
+ */
+int bb_attach(struct flash_cmd *cmd, const char *part, const char *table, long long *flen);
+
+/* Restore the callbacks of cmd */
+void bb_detach(void);
+
+#endif /* __BADBLOCK_H__ */
+/* End of [badblock.h] package */
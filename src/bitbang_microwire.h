@@ -37,6 +37,9 @@ extern int fix_addr_len;
 struct MW_EEPROM {
 	char *name;
 	unsigned int size;
+	unsigned int twc_typ;	/* Write cycle time tWC, usec */
+	unsigned int twc_max;
+	unsigned int tec_max;	/* ERAL/WRAL cycle time, usec */
 };
 
 struct gpio_cmd {
@@ -51,14 +54,14 @@ int Write_EEPROM_3wire(unsigned char *buffer, int size_eeprom);
 int deviceSize_3wire(char *eepromname);
 
 const static struct MW_EEPROM mw_eepromlist[] = {
-	{ "93c06", 32 },
-	{ "93c16", 64 },
-	{ "93c46", 128 },
-	{ "93c56", 256 },
-	{ "93c66", 512 },
-	{ "93c76", 1024 },
-	{ "93c86", 2048 },
-	{ "93c96", 4096 },
+	{ "93c06", 32,   2000, 6000, 15000 },
+	{ "93c16", 64,   2000, 6000, 15000 },
+	{ "93c46", 128,  2000, 6000, 15000 },
+	{ "93c56", 256,  2000, 6000, 15000 },
+	{ "93c66", 512,  2000, 6000, 15000 },
+	{ "93c76", 1024, 2000, 6000, 15000 },
+	{ "93c86", 2048, 2000, 6000, 15000 },
+	{ "93c96", 4096, 2000, 6000, 15000 },
 	{ 0, 0 }
 };
 
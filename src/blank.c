@@ -0,0 +1,200 @@
+/*
+ * blank.c
+ *
+ * Blank check: the range is read in chunks of whole erase units and each
+ * chunk is scanned for a byte that is not 0xFF, no file and no full chip
+ * buffer. Pass/fail stops at the first unit that is not blank, the map
+ * mode reads on and lists the runs of units that are not blank. With -d
+ * a SPI NAND is read raw, so the OOB is checked too.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLANK_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define BLANK_NEON
+#endif
+
+#include "blank.h"
+#include "timer.h"
+
+#define BLANK_CHUNK	(1024 * 1024)	/* bytes per driver call, whole units */
+#define BLANK_UNIT	4096		/* unit when the chip has no erase command */
+
+typedef unsigned long (*blank_scan_t)(const unsigned char *p, unsigned long len);
+
+/* Offset of the first byte that is not 0xFF, len if there is none */
+static unsigned long blank_scan_c(const unsigned char *p, unsigned long len)
+{
+	unsigned long i;
+	uint64_t v;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		memcpy(&v, p + i, 8);
+		if (v != ~0ULL)
+			break;
+	}
+	for (; i < len && p[i] == 0xff; i++)
+		;
+	return i;
+}
+
+#ifdef BLANK_AVX2
+/* 128 bytes ANDed per compare, the scalar scan finds the byte */
+__attribute__((target("avx2")))
+static unsigned long blank_scan_avx2(const unsigned char *p, unsigned long len)
+{
+	const __m256i ones = _mm256_set1_epi8(-1);
+	__m256i v;
+	unsigned long i;
+
+	for (i = 0; i + 128 <= len; i += 128) {
+		v = _mm256_and_si256(_mm256_and_si256(_mm256_loadu_si256((const __m256i *)(p + i)),
+						      _mm256_loadu_si256((const __m256i *)(p + i + 32))),
+				     _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(p + i + 64)),
+						      _mm256_loadu_si256((const __m256i *)(p + i + 96))));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, ones)) != -1)
+			break;
+	}
+	return i + blank_scan_c(p + i, len - i);
+}
+#endif
+
+#ifdef BLANK_NEON
+static unsigned long blank_scan_neon(const unsigned char *p, unsigned long len)
+{
+	uint8x16_t v;
+	unsigned long i;
+
+	for (i = 0; i + 64 <= len; i += 64) {
+		v = vandq_u8(vandq_u8(vld1q_u8(p + i), vld1q_u8(p + i + 16)),
+			     vandq_u8(vld1q_u8(p + i + 32), vld1q_u8(p + i + 48)));
+		if (vminvq_u8(v) != 0xff)
+			break;
+	}
+	return i + blank_scan_c(p + i, len - i);
+}
+#endif
+
+static blank_scan_t blank_kernel(void)
+{
+#ifdef BLANK_AVX2
+	if (__builtin_cpu_supports("avx2"))
+		return blank_scan_avx2;
+#endif
+#ifdef BLANK_NEON
+	return blank_scan_neon;
+#endif
+	return blank_scan_c;
+}
+
+static void blank_run_print(unsigned long long from, unsigned long long to, unsigned long units)
+{
+	printf("  0x%016llX - 0x%016llX  %lu unit%s\n", from, to - 1, units, units == 1 ? "" : "s");
+}
+
+int blank_check(struct flash_cmd *cmd, unsigned long long addr, unsigned long long len, int map)
+{
+	blank_scan_t scan = blank_kernel();
+	struct flash_info info;
+	unsigned long long pos, end = addr + len, ustart, uend, run = 0, last_print, start;
+	unsigned long unit = BLANK_UNIT, chunk, n, off, units = 0, dirty = 0, runs = 0, run_units = 0;
+	unsigned char *buf;
+	int ret = 0, whole = 0;
+
+	if (cmd->flash_info) {
+		cmd->flash_info(&info);
+		if (info.erase_size)
+			unit = info.erase_size;
+		else if (info.page_size)
+			unit = info.page_size;
+	}
+	chunk = BLANK_CHUNK / unit * unit;
+	if (!chunk)
+		chunk = unit;
+	/* Whole chip readers transfer everything on every call */
+	if (cmd->flash_info && info.whole_chip) {
+		chunk = len;
+		whole = 1;
+	}
+	if (!(buf = malloc(chunk))) {
+		printf("Malloc failed for blank check.\n");
+		return -1;
+	}
+
+	start = last_print = timer_usec();
+	for (pos = addr; pos < end; pos += n) {
+		/* Chunks end on unit boundaries, so a unit is never split */
+		n = whole ? end - pos : chunk - pos % unit;
+		if (n > end - pos)
+			n = end - pos;
+
+		timer_mute(1);
+		ret = cmd->flash_read(buf, pos, n) < 0 ? -1 : 0;
+		timer_mute(0);
+		if (ret < 0) {
+			printf("Read error at 0x%016llX\n", pos);
+			break;
+		}
+
+		for (off = 0; off < n; off = uend - pos) {
+			ustart = pos + off;
+			uend = (ustart / unit + 1) * unit;
+			if (uend > pos + n)
+				uend = pos + n;
+			units++;
+			if (scan(buf + off, uend - ustart) == uend - ustart) {
+				if (run_units)
+					blank_run_print(run, ustart, run_units);
+				run = run_units = 0;
+				continue;
+			}
+			dirty++;
+			if (!map) {
+				off += scan(buf + off, uend - ustart);
+				printf("Not blank at 0x%016llX: 0x%02X\n", pos + off, buf[off]);
+				ret = 1;
+				goto out;
+			}
+			if (!run_units++) {
+				if (!runs++)
+					printf("Not blank:\n");
+				run = ustart;
+			}
+		}
+
+		if (timer_usec() - last_print >= 1000000) {
+			printf("\bBlank check %d%% [%llu] of [%llu] bytes      ", timer_percent(pos + n - addr, len), pos + n - addr, len);
+			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+			fflush(stdout);
+			last_print = timer_usec();
+		}
+	}
+	if (run_units)
+		blank_run_print(run, end, run_units);
+	if (!ret && dirty)
+		ret = 1;
+out:
+	if (ret >= 0)
+		printf("Blank check: %lu of %lu units of %lu bytes are not blank, %llu ms\n",
+			dirty, units, unit, (timer_usec() - start) / 1000);
+	free(buf);
+	return ret;
+}
+/* End of [blank.c] package */
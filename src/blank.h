@@ -0,0 +1,27 @@
+/*
+ * blank.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __BLANK_H__
+#define __BLANK_H__
+
+#include "flashcmd_api.h"
+
+/*
+ * Check that addr..addr+len reads all 0xFF. map 0 stops at the first unit
+ * that is not blank, map 1 lists all of them.
+ * Returns 0 blank, 1 not blank, -1 read error.
+ */
+int blank_check(struct flash_cmd *cmd, unsigned long long addr, unsigned long long len, int map);
+
+#endif /* __BLANK_H__ */
+/* End of [blank.h] package */
@@ -0,0 +1,249 @@
+/*
+ * burnin.c
+ *
+ * Burn-in and endurance test: erase, program and verify a region for a
+ * number of cycles in one session. The data is generated per unit from
+ * the pattern, cycle and address, so verify regenerates it instead of
+ * keeping a copy, and nothing touches a file. Failures are counted per
+ * erase unit.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "burnin.h"
+#include "timer.h"
+
+#define BURNIN_UNIT	4096	/* unit when the chip has no erase command */
+
+struct burnin_unit {
+	unsigned long erase, program, verify;	/* cycles that failed */
+	unsigned long long bits;		/* bits read back wrong */
+	int last;				/* last failed cycle + 1 */
+};
+
+static const char *burnin_names[] = { "prng", "checker", "addr" };
+
+int burnin_parse_pattern(const char *s)
+{
+	int i;
+
+	for (i = 0; i < sizeof(burnin_names) / sizeof(burnin_names[0]); i++)
+		if (!strcmp(s, burnin_names[i]))
+			return i;
+	printf("Unknown pattern %s, use prng, checker or addr.\n", s);
+	return -1;
+}
+
+/* splitmix64 finalizer, spreads seed, cycle and address over the state */
+static uint64_t burnin_mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/* Contents of off..off+n in the given cycle, the same for program and verify */
+static void burnin_fill(unsigned char *buf, unsigned long n, unsigned long long off,
+			int pattern, int cycle, unsigned long long seed)
+{
+	unsigned long long a;
+	unsigned long i;
+	uint64_t s;
+	uint32_t w;
+
+	switch (pattern) {
+	case BURNIN_PRNG:
+		s = burnin_mix(seed ^ burnin_mix(off) ^ ((uint64_t)cycle << 48));
+		for (i = 0; i < n; i += 8) {
+			s ^= s << 13;
+			s ^= s >> 7;
+			s ^= s << 17;
+			memcpy(buf + i, &s, n - i < 8 ? n - i : 8);
+		}
+		break;
+	case BURNIN_CHECKER:
+		for (i = 0; i < n; i++)
+			buf[i] = (off + i + cycle) & 1 ? 0xAA : 0x55;
+		break;
+	case BURNIN_ADDR:
+		for (i = 0; i < n; i++) {
+			a = off + i;
+			w = cycle & 1 ? ~(uint32_t)(a & ~3ULL) : (uint32_t)(a & ~3ULL);
+			buf[i] = w >> (8 * (a & 3));
+		}
+		break;
+	}
+}
+
+/* Count a unit once per cycle however many phases it failed */
+static void burnin_failed(struct burnin_unit *u, int cycle, unsigned long *failed)
+{
+	if (u->last != cycle + 1) {
+		u->last = cycle + 1;
+		(*failed)++;
+	}
+}
+
+static int burnin_shown;	/* characters of the progress line on screen */
+
+static void burnin_progress(int cycle, int cycles, const char *phase, unsigned long done,
+			    unsigned long total, unsigned long long *last)
+{
+	if (timer_usec() - *last < 1000000)
+		return;
+	burnin_shown = printf("\bCycle %d/%d %s %d%% [%lu] of [%lu] units      ", cycle + 1, cycles, phase,
+		timer_percent(done, total), done, total);
+	printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+	fflush(stdout);
+	*last = timer_usec();
+}
+
+/* Blank the progress line so a summary line starts on a clean line */
+static void burnin_clear(void)
+{
+	int i;
+
+	if (!burnin_shown)
+		return;
+	printf("%*s", burnin_shown, "");
+	for (i = 0; i < burnin_shown; i++)
+		putchar('\b');
+	burnin_shown = 0;
+}
+
+int burnin_run(struct flash_cmd *cmd, unsigned long long addr, unsigned long long len,
+	       int cycles, int pattern, unsigned long long seed)
+{
+	struct flash_info info;
+	struct burnin_unit *u = NULL;
+	unsigned long unit = BURNIN_UNIT, nunits, i, n, failed, cycle_failed, diff;
+	unsigned long long off, t[4], last = 0, total_us = 0, bits = 0;
+	unsigned char *exp = NULL, *got = NULL, checker[2];
+	int c, nand_fill, erase = 0, ret = -1;
+
+	memset(&info, 0, sizeof(info));
+	if (cmd->flash_info)
+		cmd->flash_info(&info);
+	if (info.erase_size) {
+		unit = info.erase_size;
+		erase = 1;
+	} else if (info.page_size) {
+		unit = info.page_size;
+	}
+	if (info.whole_chip)
+		unit = len;
+	if (erase && (addr % unit || len % unit)) {
+		printf("Burn-in range must be whole erase units of 0x%lX bytes\n", unit);
+		return -1;
+	}
+	nunits = (len + unit - 1) / unit;
+
+	/* NAND pages of a checkerboard are all alike, the cache register is reused */
+	nand_fill = cmd->flash_erase == snand_erase && pattern == BURNIN_CHECKER;
+
+	u = calloc(nunits, sizeof(*u));
+	exp = malloc(unit);
+	got = malloc(unit);
+	if (!u || !exp || !got) {
+		printf("Malloc failed for burn-in.\n");
+		goto out;
+	}
+
+	printf("Burn-in: %d cycles of %s over %lu units of %lu bytes, seed 0x%llX\n",
+		cycles, burnin_names[pattern], nunits, unit, seed);
+	for (c = 0; c < cycles; c++) {
+		cycle_failed = 0;
+		t[0] = timer_usec();
+
+		for (i = 0; erase && i < nunits; i++) {
+			timer_mute(1);
+			if (cmd->flash_erase(addr + (unsigned long long)i * unit, unit) != 0) {
+				u[i].erase++;
+				burnin_failed(&u[i], c, &cycle_failed);
+			}
+			timer_mute(0);
+			burnin_progress(c, cycles, "erase", i + 1, nunits, &last);
+		}
+		t[1] = timer_usec();
+
+		checker[0] = c & 1 ? 0xAA : 0x55;
+		checker[1] = c & 1 ? 0x55 : 0xAA;
+		for (i = 0; i < nunits; i++) {
+			off = addr + (unsigned long long)i * unit;
+			n = len - (off - addr) < unit ? len - (off - addr) : unit;
+			timer_mute(1);
+			if (nand_fill) {
+				if (snand_program_pattern(off, n, checker, sizeof(checker), 0) != 0) {
+					u[i].program++;
+					burnin_failed(&u[i], c, &cycle_failed);
+				}
+			} else {
+				burnin_fill(exp, n, off, pattern, c, seed);
+				if (cmd->flash_write(exp, off, n) < 0) {
+					u[i].program++;
+					burnin_failed(&u[i], c, &cycle_failed);
+				}
+			}
+			timer_mute(0);
+			burnin_progress(c, cycles, "program", i + 1, nunits, &last);
+		}
+		t[2] = timer_usec();
+
+		for (i = 0; i < nunits; i++) {
+			off = addr + (unsigned long long)i * unit;
+			n = len - (off - addr) < unit ? len - (off - addr) : unit;
+			timer_mute(1);
+			if (cmd->flash_read(got, off, n) < 0)
+				memset(got, 0, n);
+			timer_mute(0);
+			burnin_fill(exp, n, off, pattern, c, seed);
+			if (memcmp(exp, got, n)) {
+				for (n--, diff = 0; n != (unsigned long)-1; n--)
+					diff += __builtin_popcount(exp[n] ^ got[n]);
+				u[i].verify++;
+				u[i].bits += diff;
+				bits += diff;
+				burnin_failed(&u[i], c, &cycle_failed);
+			}
+			burnin_progress(c, cycles, "verify", i + 1, nunits, &last);
+		}
+		t[3] = timer_usec();
+
+		total_us += t[3] - t[0];
+		burnin_clear();
+		printf("Cycle %d/%d: erase %llu ms, program %llu ms, verify %llu ms, %lu units failed\n",
+			c + 1, cycles, (t[1] - t[0]) / 1000, (t[2] - t[1]) / 1000, (t[3] - t[2]) / 1000, cycle_failed);
+	}
+
+	for (i = 0, failed = 0; i < nunits; i++) {
+		if (!u[i].erase && !u[i].program && !u[i].verify)
+			continue;
+		if (!failed++)
+			printf("Unit    Address             Erase  Program  Verify  Bits\n");
+		printf("%-7lu 0x%016llX  %-6lu %-8lu %-7lu %llu\n", i, addr + (unsigned long long)i * unit,
+			u[i].erase, u[i].program, u[i].verify, u[i].bits);
+	}
+	printf("Burn-in: %d cycles, %lu of %lu units failed, %llu bits read back wrong, %llu ms per cycle\n",
+		cycles, failed, nunits, bits, cycles ? total_us / cycles / 1000 : 0);
+	ret = failed ? 1 : 0;
+out:
+	free(u);
+	free(exp);
+	free(got);
+	return ret;
+}
+/* End of [burnin.c] package */
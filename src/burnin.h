@@ -0,0 +1,35 @@
+/*
+ * burnin.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __BURNIN_H__
+#define __BURNIN_H__
+
+#include "flashcmd_api.h"
+
+enum burnin_pattern {
+	BURNIN_PRNG,		/* xorshift per unit, seeded by seed, cycle and address */
+	BURNIN_CHECKER,		/* 55h/AAh, inverted every cycle */
+	BURNIN_ADDR,		/* 32-bit byte address in every word, inverted every cycle */
+};
+
+int burnin_parse_pattern(const char *s);
+
+/*
+ * Erase, program and verify addr..addr+len cycles times with a generated
+ * pattern. Returns 0 when every cycle passed.
+ */
+int burnin_run(struct flash_cmd *cmd, unsigned long long addr, unsigned long long len,
+	       int cycles, int pattern, unsigned long long seed);
+
+#endif /* __BURNIN_H__ */
+/* End of [burnin.h] package */
@@ -24,6 +24,8 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "sim.h"
+
 #define DEFAULT_TIMEOUT			1000
 #define BULK_WRITE_ENDPOINT		0x02
 #define BULK_READ_ENDPOINT		0x82
@@ -43,6 +45,9 @@ static int usb_transf(const char *func, uint8_t type, uint8_t *buf, int len)
 {
 	int ret, actuallen = 0;
 
+	if (sim_enable)
+		return sim_bulk_transfer(type, buf, len);
+
 	if (handle == NULL)
 		return -1;
 
@@ -26,6 +26,7 @@
 #include <string.h>
 #include <assert.h>
 #include "ch341a_i2c.h"
+#include "sim.h"
 
 #define dprintf(args...)
 // #define dprintf(args...) do { if (1) printf(args); } while(0)
@@ -102,6 +103,35 @@ void ch341ReadCmdMarshall(uint8_t *buffer, uint32_t addr, struct EEPROM *eeprom_
 	assert(ptr - buffer == CH341_EEPROM_READ_CMD_SZ);
 }
 
+// --------------------------------------------------------------------------
+// ch341readEEPROMsync()
+//      same command stream as ch341readEEPROM() on blocking transfers, for the simulator
+static int32_t ch341readEEPROMsync(uint8_t *buffer, uint32_t bytestoread, struct EEPROM *eeprom_info)
+{
+	uint8_t ch341outBuffer[EEPROM_READ_BULKOUT_BUF_SZ];
+	uint32_t offset;
+	int i;
+
+	for (offset = 0; offset < bytestoread; offset += 4 * EEPROM_READ_BULKIN_BUF_SZ) {
+		ch341ReadCmdMarshall(ch341outBuffer, offset, eeprom_info);
+		if (sim_bulk_transfer(BULK_WRITE_ENDPOINT, ch341outBuffer, EEPROM_READ_BULKOUT_BUF_SZ) < 0)
+			return -1;
+		for (i = 0; i < 4; i++) {
+			if (sim_bulk_transfer(BULK_READ_ENDPOINT, buffer + offset + i * EEPROM_READ_BULKIN_BUF_SZ,
+					      EEPROM_READ_BULKIN_BUF_SZ) != EEPROM_READ_BULKIN_BUF_SZ) {
+				printf("USB read error : short packet\n");
+				return -1;
+			}
+		}
+		printf("Read %d%% [%d] of [%d] bytes      ", 100 * offset / bytestoread, offset, bytestoread);
+		printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+		fflush(stdout);
+	}
+	printf("Read 100%% [%d] of [%d] bytes      \n", bytestoread, bytestoread);
+
+	return 0;
+}
+
 // --------------------------------------------------------------------------
 // ch341readEEPROM()
 //      read n bytes from device (in packets of 32 bytes)
@@ -113,6 +143,9 @@ int32_t ch341readEEPROM(uint8_t *buffer, uint32_t bytestoread, struct EEPROM *ee
 	struct libusb_transfer *xferBulkIn, *xferBulkOut;
 	struct timeval tv = {0, 100};     // our async polling interval
 
+	if (sim_enable)
+		return ch341readEEPROMsync(buffer, bytestoread, eeprom_info);
+
 	xferBulkIn  = libusb_alloc_transfer(0);
 	xferBulkOut = libusb_alloc_transfer(0);
 
@@ -226,104 +259,135 @@ void cbBulkOut(struct libusb_transfer *transfer)
 	return;
 }
 
+static int ch341bulkWrite(uint8_t *buf, int len, int32_t *actuallen)
+{
+	if (sim_enable) {
+		*actuallen = sim_bulk_transfer(BULK_WRITE_ENDPOINT, buf, len);
+		return *actuallen < 0 ? LIBUSB_ERROR_IO : 0;
+	}
+
+	return libusb_bulk_transfer(handle, BULK_WRITE_ENDPOINT, buf, len, actuallen, DEFAULT_TIMEOUT);
+}
+
+// --------------------------------------------------------------------------
+// ch341twrEEPROM()
+//      write cycle time the stream waits after every page, in ms
+int32_t ch341twrEEPROM(struct EEPROM *eeprom_info)
+{
+	int32_t ms = ((*eeprom_info).twr_max + 999) / 1000;
+
+	return MAX(MIN(ms, mCH341A_CMD_I2C_STM_DLY), 1);
+}
+
+// --------------------------------------------------------------------------
+// ch341pageEEPROM()
+//      stream packets of one page write of len bytes at offset into out,
+//      len must not cross the page; returns the bytes used in out
+uint32_t ch341pageEEPROM(uint8_t *out, uint8_t *buffer, uint32_t offset, uint16_t len, struct EEPROM *eeprom_info)
+{
+	uint8_t i2cCmdBuffer[EEPROM_MAX_PAGE_SIZE + 3];
+	uint8_t *outptr, *pktptr, *i2cBufPtr;
+	uint16_t page_size_left;
+	uint8_t part_no = 0, room, to_write;
+
+	outptr = i2cCmdBuffer;
+	if ((*eeprom_info).addr_size >= 2) {
+		*outptr++ = (uint8_t) (0xa0 | (offset >> 16 & (*eeprom_info).i2c_addr_mask) << 1); // EEPROM device address
+		*outptr++ = (uint8_t) (offset >> 8 & 0xff); // MSB (big-endian) byte address
+	} else {
+		*outptr++ = (uint8_t) (0xa0 | (offset >> 8 & (*eeprom_info).i2c_addr_mask) << 1); // EEPROM device address
+	}
+	*outptr++ = (uint8_t) (offset & 0xff); // LSB of 16-bit    byte address
+
+	memcpy(outptr, buffer, len);
+	page_size_left = outptr + len - i2cCmdBuffer;
+
+	// The CH341A parses every 32 byte USB packet on its own, so an OUT
+	// never crosses one and each packet starts with the stream command
+	outptr = out;
+	i2cBufPtr = i2cCmdBuffer;
+	while (page_size_left) {
+		pktptr = outptr;
+		*outptr++ = mCH341A_CMD_I2C_STREAM;
+		if (part_no == 0) { // Start packet
+			*outptr++ = mCH341A_CMD_I2C_STM_STA;
+		}
+		room = mCH341_PACKET_LENGTH - (outptr - pktptr) - 3; // OUT, STO, END
+		to_write = MIN(page_size_left, room);
+		*outptr++ = mCH341A_CMD_I2C_STM_OUT | to_write;
+		memcpy(outptr, i2cBufPtr, to_write);
+		outptr += to_write;
+		i2cBufPtr += to_write;
+		page_size_left -= to_write;
+
+		if (page_size_left == 0) { // Stop packet
+			*outptr++ = mCH341A_CMD_I2C_STM_STO;
+		}
+		*outptr++ = mCH341A_CMD_I2C_STM_END;
+		memset(outptr, 0, pktptr + mCH341_PACKET_LENGTH - outptr);
+		outptr = pktptr + mCH341_PACKET_LENGTH;
+		part_no++;
+	}
+
+	return outptr - out;
+}
+
+// --------------------------------------------------------------------------
+// ch341sendEEPROM()
+//      bulk write of prepared stream packets
+int32_t ch341sendEEPROM(uint8_t *out, uint32_t len)
+{
+	int32_t ret, i, actuallen = 0;
+
+	for (i = 0; i < len; i++) {
+		if(!(i % 0x10))
+			dprintf("\n%04x : ", i);
+		dprintf("%02x ", out[i]);
+	}
+	dprintf("\n");
+
+	ret = ch341bulkWrite(out, len, &actuallen);
+	if (ret < 0) {
+		printf("Failed to write to EEPROM: '%s'\n", strerror(-ret));
+		return -1;
+	}
+	return 0;
+}
+
 // --------------------------------------------------------------------------
 // ch341writeEEPROM()
-//      write n bytes to 24c32/24c64 device (in packets of 32 bytes)
-int32_t ch341writeEEPROM(uint8_t *buffer, uint32_t bytesum, struct EEPROM *eeprom_info)
+//      write bytesum bytes at offset, one page write per page touched; the
+//      first and last pages may be partial. Every page goes out with a tWR
+//      delay packet after it, in one bulk transfer
+int32_t ch341writeEEPROM(uint8_t *buffer, uint32_t offset, uint32_t bytesum, struct EEPROM *eeprom_info)
 {
-	uint8_t ch341outBuffer[512/*EEPROM_WRITE_BUF_SZ*/];
+	uint8_t ch341outBuffer[EEPROM_WRITE_BUF_SZ];
 	uint8_t *outptr, *bufptr;
-	uint8_t i2cCmdBuffer[256];
-	int32_t ret = 0, i;
-	uint32_t payload_size, byteoffset = 0;
+	uint32_t byteoffset = offset;
 	uint32_t bytes = bytesum;
-	uint8_t addrbytecount = (*eeprom_info).addr_size + 1; // 24c32 and 24c64 (and other 24c??) use 3 bytes for addressing
-	int32_t actuallen = 0;
 	uint16_t page_size = (*eeprom_info).page_size;
-	uint16_t page_size_left;
-	uint8_t part_no;
-	uint8_t *i2cBufPtr;
+	uint16_t chunk;
 
 	bufptr = buffer;
 
 	while (bytes) {
-		outptr = i2cCmdBuffer;
-		if ((*eeprom_info).addr_size >= 2) {
-			*outptr++ = (uint8_t) (0xa0 | (byteoffset >> 16 & (*eeprom_info).i2c_addr_mask) << 1); // EEPROM device address
-			*outptr++ = (uint8_t) (byteoffset >> 8 & 0xff); // MSB (big-endian) byte address
-		} else {
-			*outptr++ = (uint8_t) (0xa0 | (byteoffset >> 8 & (*eeprom_info).i2c_addr_mask) << 1); // EEPROM device address
-		}
-		*outptr++ = (uint8_t) (byteoffset & 0xff); // LSB of 16-bit    byte address
-
-		memcpy(outptr, bufptr, page_size); // Copy one page
-
-		byteoffset += page_size;
-		bufptr += page_size;
-		bytes  -= page_size;
-
-		outptr = ch341outBuffer;
-		page_size_left = page_size + addrbytecount;
-		part_no = 0;
-		i2cBufPtr = i2cCmdBuffer;
-		while (page_size_left) {
-			uint8_t to_write = MIN(page_size_left, 28);
-			*outptr++ = mCH341A_CMD_I2C_STREAM;
-			if (part_no == 0) { // Start packet
-				*outptr++ = mCH341A_CMD_I2C_STM_STA;
-			}
-			*outptr++ = mCH341A_CMD_I2C_STM_OUT | to_write;
-			memcpy(outptr, i2cBufPtr, to_write);
-			outptr += to_write;
-			i2cBufPtr += to_write;
-			page_size_left -= to_write;
-
-			if (page_size_left == 0) { // Stop packet
-				*outptr++ = mCH341A_CMD_I2C_STM_STO;
-			}
-			*outptr++ = mCH341A_CMD_I2C_STM_END;
-			part_no++;
-		}
-		payload_size = outptr - ch341outBuffer;
+		// Up to the end of the page, a page write wraps within the page
+		chunk = MIN(bytes, page_size - byteoffset % page_size);
 
-		for (i = 0; i < payload_size; i++) {
-			if(!(i % 0x10))
-				dprintf("\n%04x : ", i);
-			dprintf("%02x ", ch341outBuffer[i]);
-		}
-		dprintf("\n");
+		outptr = ch341outBuffer + ch341pageEEPROM(ch341outBuffer, bufptr, byteoffset, chunk, eeprom_info);
 
-		ret = libusb_bulk_transfer(handle, BULK_WRITE_ENDPOINT,
-					    ch341outBuffer, payload_size, &actuallen, DEFAULT_TIMEOUT);
+		byteoffset += chunk;
+		bufptr += chunk;
+		bytes  -= chunk;
 
-		if (ret < 0) {
-			printf("Failed to write to EEPROM: '%s'\n", strerror(-ret));
-			return -1;
-		}
-
-		dprintf("Writing [aa 5a 00] to EEPROM\n"); // Magic CH341a packet! Undocumented, unknown purpose
-
-		outptr = ch341outBuffer;
+		// Wait out tWR before the next page is addressed
 		*outptr++ = mCH341A_CMD_I2C_STREAM;
-		*outptr++ = 0x5a;  // what is this 0x5a??
+		*outptr++ = mCH341A_CMD_I2C_STM_MS | ch341twrEEPROM(eeprom_info);
 		*outptr++ = mCH341A_CMD_I2C_STM_END;
 
-		ret = libusb_bulk_transfer(handle, BULK_WRITE_ENDPOINT, ch341outBuffer, 3, &actuallen, DEFAULT_TIMEOUT);
-
-		if (ret < 0) {
-			printf("Failed to write to EEPROM: '%s'\n", strerror(-ret));
+		if (ch341sendEEPROM(ch341outBuffer, outptr - ch341outBuffer) < 0)
 			return -1;
-		}
 
-		/*
-		struct timeval tv = {0, 100};                   // our async polling interval
-		ret = libusb_handle_events_timeout(NULL, &tv);
-		if (ret < 0) {          // indicates an error
-			fprintf(stderr, "ret from libusb_handle_timeout = %d\n", ret);
-			fprintf(stderr, "USB read error : %s\n", strerror(-ret));
-			return -1;
-		}
-		*/
 		printf("\bWritten %d%% [%d] of [%d] bytes      ", 100 * (bytesum - bytes) / bytesum, bytesum - bytes, bytesum);
 		printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
 		fflush(stdout);
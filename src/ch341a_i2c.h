@@ -18,7 +18,8 @@
 #define DEFAULT_TIMEOUT			300    // 300mS for USB timeouts
 
 #define IN_BUF_SZ			0x100
-#define EEPROM_WRITE_BUF_SZ		0x2b   // only for 24c64 / 24c32 ??
+#define EEPROM_MAX_PAGE_SIZE		256    // 24c1024
+#define EEPROM_WRITE_BUF_SZ		(12 * mCH341_PACKET_LENGTH)   // one page + address in 27 byte parts, tWR delay
 #define EEPROM_READ_BULKIN_BUF_SZ	0x20
 #define EEPROM_READ_BULKOUT_BUF_SZ	0x65
 
@@ -73,8 +74,8 @@
 #define mCH341A_CMD_I2C_STM_MAX		( min( 0x3F, mCH341_PACKET_LENGTH ) )  /* Unused on the source*/
 #define mCH341A_CMD_I2C_STM_SET		0x60
 #define mCH341A_CMD_I2C_STM_US		0x40  /* Unused on the source*/
-#define mCH341A_CMD_I2C_STM_MS		0x50  /* Unused on the source*/
-#define mCH341A_CMD_I2C_STM_DLY		0x0F  /* Unused on the source*/
+#define mCH341A_CMD_I2C_STM_MS		0x50
+#define mCH341A_CMD_I2C_STM_DLY		0x0F
 #define mCH341A_CMD_I2C_STM_END		0x00
 
 #define mCH341A_CMD_UIO_STM_IN		0x00  /* Unused on the source*/
@@ -96,6 +97,7 @@
 #define CH341_I2C_STANDARD_SPEED	1 // standard speed - 100kHz
 #define CH341_I2C_FAST_SPEED		2 // fast speed - 400kHz
 #define CH341_I2C_HIGH_SPEED		3 // high speed - 750kHz
+#define CH341_I2C_STANDARD_RATE		(100000 / 9) // bytes/sec at 100kHz, 8 data bits + ACK
 
 #define CH341_EEPROM_READ_CMD_SZ	0x65 /* Same size for all 24cXX read setup and next packets*/
 
@@ -344,26 +346,31 @@ struct EEPROM {
 	uint16_t page_size;
 	uint8_t addr_size; // Length of addres in bytes
 	uint8_t i2c_addr_mask;
+	uint32_t twr_typ; // Write cycle time tWR, usec
+	uint32_t twr_max;
 };
 
 const static struct EEPROM eepromlist[] = {
-	{ "24c01",   128,     8,  1, 0x00 }, // 16 pages of 8 bytes each = 128 bytes
-	{ "24c02",   256,     8,  1, 0x00 }, // 32 pages of 8 bytes each = 256 bytes
-	{ "24c04",   512,    16,  1, 0x01 }, // 32 pages of 16 bytes each = 512 bytes
-	{ "24c08",   1024,   16,  1, 0x03 }, // 64 pages of 16 bytes each = 1024 bytes
-	{ "24c16",   2048,   16,  1, 0x07 }, // 128 pages of 16 bytes each = 2048 bytes
-	{ "24c32",   4096,   32,  2, 0x00 }, // 32kbit = 4kbyte
-	{ "24c64",   8192,   32,  2, 0x00 },
-	{ "24c128",  16384,  32/*64*/,  2, 0x00 },
-	{ "24c256",  32768,  32/*64*/,  2, 0x00 },
-	{ "24c512",  65536,  32/*128*/, 2, 0x00 },
-	{ "24c1024", 131072, 32/*128*/, 2, 0x01 },
+	{ "24c01",   128,     8,  1, 0x00, 3000, 5000 }, // 16 pages of 8 bytes each = 128 bytes
+	{ "24c02",   256,     8,  1, 0x00, 3000, 5000 }, // 32 pages of 8 bytes each = 256 bytes
+	{ "24c04",   512,    16,  1, 0x01, 3000, 5000 }, // 32 pages of 16 bytes each = 512 bytes
+	{ "24c08",   1024,   16,  1, 0x03, 3000, 5000 }, // 64 pages of 16 bytes each = 1024 bytes
+	{ "24c16",   2048,   16,  1, 0x07, 3000, 5000 }, // 128 pages of 16 bytes each = 2048 bytes
+	{ "24c32",   4096,   32,  2, 0x00, 3000, 5000 }, // 32kbit = 4kbyte
+	{ "24c64",   8192,   32,  2, 0x00, 3000, 5000 },
+	{ "24c128",  16384,  64,  2, 0x00, 3000, 5000 },
+	{ "24c256",  32768,  64,  2, 0x00, 3000, 5000 },
+	{ "24c512",  65536,  128, 2, 0x00, 3000, 5000 },
+	{ "24c1024", 131072, 256, 2, 0x01, 3000, 5000 },
 	{ 0, 0, 0, 0 }
 };
 
 
 int32_t ch341readEEPROM(uint8_t *buf, uint32_t bytes, struct EEPROM *eeprom_info);
-int32_t ch341writeEEPROM(uint8_t *buf, uint32_t bytes, struct EEPROM *eeprom_info);
+int32_t ch341writeEEPROM(uint8_t *buf, uint32_t offset, uint32_t bytes, struct EEPROM *eeprom_info);
+int32_t ch341twrEEPROM(struct EEPROM *eeprom_info);
+uint32_t ch341pageEEPROM(uint8_t *out, uint8_t *buf, uint32_t offset, uint16_t len, struct EEPROM *eeprom_info);
+int32_t ch341sendEEPROM(uint8_t *out, uint32_t len);
 int32_t parseEEPsize(char *eepromname, struct EEPROM *eeprom);
 
 #endif /* __CH341A_I2C_H__ */
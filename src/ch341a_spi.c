@@ -23,7 +23,10 @@
  */
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "ch341a_spi.h"
+#include "spi_speed.h"
+#include "sim.h"
 #include <libusb-1.0/libusb.h>
 #include <stdbool.h>
 
@@ -98,6 +101,36 @@ const struct dev_entry devs_ch341a_spi[] = {
 
 enum trans_state {TRANS_ACTIVE = -2, TRANS_ERR = -1, TRANS_IDLE = 0};
 
+/* Asynchronous transactions. Each one is queued as two OUT transfers, CS low
+ * with the SPI stream and CS high, plus its share of the IN transfers, so the
+ * next transaction is encoded and queued while the current one is on the
+ * wire. The single OUT endpoint keeps them in submission order, and the IN
+ * transfers are queued in the same order, so every transaction gets its own
+ * bytes back. A transaction ends in a short packet, which is why CS high
+ * cannot share its OUT transfer. */
+enum async_state {ASYNC_FREE = 0, ASYNC_ACTIVE, ASYNC_DONE, ASYNC_ERR};
+
+struct async_xfer {
+	enum async_state state;
+	struct libusb_transfer *out[2];	/* CS low + stream, CS high */
+	int state_out[2];
+	uint8_t *wbuf, *rbuf;
+	unsigned int writecnt, readcnt;
+	unsigned int in_len, in_sub, in_done;	/* IN bytes: total, queued, received */
+	unsigned char *readarr;
+};
+
+static struct async_xfer async_q[CH341A_ASYNC_DEPTH];
+static struct libusb_transfer *async_ins[USB_IN_TRANSFERS];
+static int async_in_state[USB_IN_TRANSFERS];
+static struct async_xfer *async_in_owner[USB_IN_TRANSFERS];
+static unsigned int async_free_idx, async_in_idx;
+static int async_seq;		/* handle of the next transaction */
+static int async_tail;		/* oldest transaction still on the wire */
+static int async_error;		/* sticky until ch341a_spi_flush() reports it */
+
+void (*ch341a_spi_idle)(void) = NULL;
+
 #if 0
 static void print_hex(const void *buf, size_t len)
 {
@@ -142,9 +175,21 @@ static void LIBUSB_CALL cb_in(struct libusb_transfer *transfer)
 
 static int32_t usb_transfer(const char *func, unsigned int writecnt, unsigned int readcnt, const uint8_t *writearr, uint8_t *readarr)
 {
+	if (sim_enable) {
+		if (writecnt && sim_bulk_transfer(WRITE_EP, (uint8_t *)writearr, writecnt) < 0)
+			return -1;
+		if (readcnt && sim_bulk_transfer(READ_EP, readarr, readcnt) < (int)readcnt)
+			return -1;
+		return 0;
+	}
+
 	if (handle == NULL)
 		return -1;
 
+	/* Queued transactions own the IN stream until they are complete */
+	if (async_tail < async_seq && ch341a_spi_flush() < 0)
+		return -1;
+
 	int state_out = TRANS_IDLE;
 	transfer_out->buffer = (uint8_t*)writearr;
 	transfer_out->length = writecnt;
@@ -268,7 +313,7 @@ err:
  *   Set the SPI bus data width (speed(b2): 0 = Single, 1 = Double).  */
 int config_stream(unsigned int speed)
 {
-	if (handle == NULL)
+	if (handle == NULL && !sim_enable)
 		return -1;
 
 	uint8_t buf[] = {
@@ -306,21 +351,29 @@ static uint8_t swap_byte(uint8_t x)
  *	D6/21	unused	(DIN2)
  *	D7/22	SO/2	(DIN)
  */
+static unsigned int pins_packet(uint8_t *buf, bool enable)
+{
+	uint8_t *p = buf;
+
+	*p++ = CH341A_CMD_UIO_STREAM;
+	*p++ = CH341A_CMD_UIO_STM_OUT | 0x37; // CS high (all of them), SCK=0, DOUT*=1
+	*p++ = CH341A_CMD_UIO_STM_OUT | 0x37; // CS high (all of them), SCK=0, DOUT*=1
+	*p++ = CH341A_CMD_UIO_STM_OUT | 0x37; // CS high (all of them), SCK=0, DOUT*=1
+	*p++ = CH341A_CMD_UIO_STM_OUT | 0x37; // CS high (all of them), SCK=0, DOUT*=1
+	*p++ = CH341A_CMD_UIO_STM_OUT | 0x37; // CS high (all of them), SCK=0, DOUT*=1
+	*p++ = CH341A_CMD_UIO_STM_OUT | 0x36; // CS low (all of them), SCK=0, DOUT*=1
+	*p++ = CH341A_CMD_UIO_STM_DIR | (enable ? 0x3F : 0x00); // Interface output enable / disable
+	*p++ = CH341A_CMD_UIO_STM_END;
+
+	return p - buf;
+}
+
 int enable_pins(bool enable)
 {
-	uint8_t buf[] = {
-		CH341A_CMD_UIO_STREAM,
-		CH341A_CMD_UIO_STM_OUT | 0x37, // CS high (all of them), SCK=0, DOUT*=1
-		CH341A_CMD_UIO_STM_OUT | 0x37, // CS high (all of them), SCK=0, DOUT*=1
-		CH341A_CMD_UIO_STM_OUT | 0x37, // CS high (all of them), SCK=0, DOUT*=1
-		CH341A_CMD_UIO_STM_OUT | 0x37, // CS high (all of them), SCK=0, DOUT*=1
-		CH341A_CMD_UIO_STM_OUT | 0x37, // CS high (all of them), SCK=0, DOUT*=1
-		CH341A_CMD_UIO_STM_OUT | 0x36, // CS low (all of them), SCK=0, DOUT*=1
-		CH341A_CMD_UIO_STM_DIR | (enable ? 0x3F : 0x00), // Interface output enable / disable
-		CH341A_CMD_UIO_STM_END,
-	};
+	uint8_t buf[CH341_PACKET_LENGTH];
+	unsigned int len = pins_packet(buf, enable);
 
-	int32_t ret = usb_transfer(__func__, sizeof(buf), 0, buf, NULL);
+	int32_t ret = usb_transfer(__func__, len, 0, buf, NULL);
 	if (ret < 0) {
 		printf("Could not %sable output pins.\n", enable ? "en" : "dis");
 	}
@@ -331,9 +384,12 @@ int ch341a_spi_send_command(unsigned int writecnt, unsigned int readcnt, const u
 {
 	int32_t ret = 0;
 
-	if (handle == NULL)
+	if (handle == NULL && !sim_enable)
 		return -1;
 
+	if (ch341a_spi_idle && async_tail == async_seq)
+		ch341a_spi_idle();
+
 	/* How many packets ... */
 	const size_t packets = (writecnt + readcnt + CH341_PACKET_LENGTH - 2) / (CH341_PACKET_LENGTH - 1);
 
@@ -378,11 +434,294 @@ int ch341a_spi_send_command(unsigned int writecnt, unsigned int readcnt, const u
 	return 0;
 }
 
+static void async_free(void)
+{
+	int i;
+
+	for (i = 0; i < CH341A_ASYNC_DEPTH; i++) {
+		libusb_free_transfer(async_q[i].out[0]);
+		libusb_free_transfer(async_q[i].out[1]);
+		async_q[i].out[0] = async_q[i].out[1] = NULL;
+	}
+	for (i = 0; i < USB_IN_TRANSFERS; i++) {
+		libusb_free_transfer(async_ins[i]);
+		async_ins[i] = NULL;
+	}
+}
+
+static int async_alloc(void)
+{
+	int i, j;
+
+	if (async_ins[0] != NULL)
+		return 0;
+	for (i = 0; i < CH341A_ASYNC_DEPTH; i++) {
+		for (j = 0; j < 2; j++) {
+			if ((async_q[i].out[j] = libusb_alloc_transfer(0)) == NULL)
+				goto err;
+			libusb_fill_bulk_transfer(async_q[i].out[j], handle, WRITE_EP, NULL, 0, cb_out,
+						  &async_q[i].state_out[j], USB_TIMEOUT);
+		}
+	}
+	for (i = 0; i < USB_IN_TRANSFERS; i++) {
+		if ((async_ins[i] = libusb_alloc_transfer(0)) == NULL)
+			goto err;
+		libusb_fill_bulk_transfer(async_ins[i], handle, READ_EP, NULL, 0, cb_in,
+					  &async_in_state[i], USB_TIMEOUT);
+	}
+	return 0;
+err:
+	printf("Failed to alloc libusb transfers for queued transactions\n");
+	async_free();
+	return -1;
+}
+
+static void async_complete(struct async_xfer *x, enum async_state state)
+{
+	unsigned int i;
+
+	if (state == ASYNC_DONE)
+		for (i = 0; i < x->readcnt; i++)
+			x->readarr[i] = swap_byte(x->rbuf[x->writecnt + i]);
+	free(x->wbuf);
+	free(x->rbuf);
+	x->wbuf = x->rbuf = NULL;
+	x->state = state;
+}
+
+/* Cancel everything on the wire, the queued transactions fail */
+static void async_abort(void)
+{
+	struct async_xfer *x;
+	bool finished;
+	int s, i;
+
+	for (s = async_tail; s < async_seq; s++) {
+		x = &async_q[s % CH341A_ASYNC_DEPTH];
+		for (i = 0; i < 2; i++)
+			if (x->state_out[i] == TRANS_ACTIVE && libusb_cancel_transfer(x->out[i]) != 0)
+				x->state_out[i] = TRANS_ERR;
+	}
+	for (i = 0; i < USB_IN_TRANSFERS; i++)
+		if (async_in_state[i] == TRANS_ACTIVE && libusb_cancel_transfer(async_ins[i]) != 0)
+			async_in_state[i] = TRANS_ERR;
+
+	do {
+		finished = true;
+		for (s = async_tail; s < async_seq; s++) {
+			x = &async_q[s % CH341A_ASYNC_DEPTH];
+			if (x->state_out[0] == TRANS_ACTIVE || x->state_out[1] == TRANS_ACTIVE)
+				finished = false;
+		}
+		for (i = 0; i < USB_IN_TRANSFERS; i++)
+			if (async_in_state[i] == TRANS_ACTIVE)
+				finished = false;
+		if (!finished)
+			libusb_handle_events_timeout(NULL, &(struct timeval){1, 0});
+	} while (!finished);
+
+	for (s = async_tail; s < async_seq; s++) {
+		x = &async_q[s % CH341A_ASYNC_DEPTH];
+		if (x->state == ASYNC_ACTIVE)
+			async_complete(x, ASYNC_ERR);
+	}
+	for (i = 0; i < USB_IN_TRANSFERS; i++)
+		async_in_state[i] = TRANS_IDLE;
+	async_free_idx = async_in_idx = 0;
+	async_tail = async_seq;
+	async_error = 1;
+}
+
+/* Queue IN transfers, handle USB events and retire finished transactions */
+static int async_pump(bool block)
+{
+	struct async_xfer *x;
+	struct libusb_transfer *t;
+	unsigned int n;
+	int s;
+
+	for (s = async_tail; s < async_seq; s++) {
+		x = &async_q[s % CH341A_ASYNC_DEPTH];
+		while (x->in_sub < x->in_len && async_in_state[async_free_idx] == TRANS_IDLE) {
+			n = min(CH341_PACKET_LENGTH - 1, x->in_len - x->in_sub);
+			t = async_ins[async_free_idx];
+			t->buffer = x->rbuf + x->in_sub;
+			t->length = n;
+			if (libusb_submit_transfer(t)) {
+				printf("%s: failed to submit IN transfer\n", __func__);
+				goto err;
+			}
+			async_in_state[async_free_idx] = TRANS_ACTIVE;
+			async_in_owner[async_free_idx] = x;
+			x->in_sub += n;
+			async_free_idx = (async_free_idx + 1) % USB_IN_TRANSFERS;
+		}
+		/* Later transactions must not overtake this one on the IN stream */
+		if (x->in_sub < x->in_len)
+			break;
+	}
+
+	libusb_handle_events_timeout(NULL, &(struct timeval){block ? 1 : 0, 0});
+
+	while (async_in_state[async_in_idx] != TRANS_IDLE && async_in_state[async_in_idx] != TRANS_ACTIVE) {
+		t = async_ins[async_in_idx];
+		if (async_in_state[async_in_idx] == TRANS_ERR || t->actual_length != t->length) {
+			printf("%s: IN transfer failed\n", __func__);
+			goto err;
+		}
+		async_in_owner[async_in_idx]->in_done += t->actual_length;
+		async_in_state[async_in_idx] = TRANS_IDLE;
+		async_in_idx = (async_in_idx + 1) % USB_IN_TRANSFERS;
+	}
+
+	for (s = async_tail; s < async_seq; s++) {
+		x = &async_q[s % CH341A_ASYNC_DEPTH];
+		if (x->state_out[0] == TRANS_ERR || x->state_out[1] == TRANS_ERR) {
+			printf("%s: OUT transfer failed\n", __func__);
+			goto err;
+		}
+		if (x->state_out[0] == TRANS_ACTIVE || x->state_out[1] == TRANS_ACTIVE || x->in_done < x->in_len)
+			break;
+		async_complete(x, ASYNC_DONE);
+		async_tail = s + 1;
+	}
+	return 0;
+err:
+	async_abort();
+	return -1;
+}
+
+int ch341a_spi_submit(unsigned int writecnt, unsigned int readcnt, const unsigned char *writearr, unsigned char *readarr)
+{
+	struct async_xfer *x;
+	unsigned int i, p, len, packets;
+	uint8_t *ptr;
+	int h, j;
+
+	if (handle == NULL && !sim_enable)
+		return -1;
+	if (async_error || (!sim_enable && async_alloc() < 0))
+		return -1;
+	if (ch341a_spi_idle && async_tail == async_seq)
+		ch341a_spi_idle();
+
+	/* Bounded in flight, the oldest has to finish first */
+	while (async_seq - async_tail >= CH341A_ASYNC_DEPTH)
+		if (async_pump(true) < 0)
+			return -1;
+
+	x = &async_q[async_seq % CH341A_ASYNC_DEPTH];
+	packets = (writecnt + readcnt + CH341_PACKET_LENGTH - 2) / (CH341_PACKET_LENGTH - 1);
+	x->wbuf = malloc(CH341_PACKET_LENGTH * (packets + 2));
+	x->rbuf = malloc(writecnt + readcnt + 1);
+	if (x->wbuf == NULL || x->rbuf == NULL) {
+		printf("Malloc failed for SPI transaction.\n");
+		async_complete(x, ASYNC_FREE);
+		return -1;
+	}
+	x->writecnt = writecnt;
+	x->readcnt = readcnt;
+	x->readarr = readarr;
+	x->in_len = writecnt + readcnt;
+	x->in_sub = x->in_done = 0;
+
+	memset(x->wbuf, 0, CH341_PACKET_LENGTH);
+	pins_packet(x->wbuf, true);
+	ptr = x->wbuf + CH341_PACKET_LENGTH;
+	for (p = 0; p < packets; p++) {
+		unsigned int write_now = min(CH341_PACKET_LENGTH - 1, writecnt);
+		unsigned int read_now = min((CH341_PACKET_LENGTH - 1) - write_now, readcnt);
+		*ptr++ = CH341A_CMD_SPI_STREAM;
+		for (i = 0; i < write_now; i++)
+			*ptr++ = swap_byte(*writearr++);
+		memset(ptr, 0xFF, read_now);
+		ptr += read_now;
+		writecnt -= write_now;
+		readcnt -= read_now;
+	}
+	len = ptr - x->wbuf;
+	ptr = x->wbuf + CH341_PACKET_LENGTH * (packets + 1);
+	pins_packet(ptr, false);
+
+	x->state = ASYNC_ACTIVE;
+	h = async_seq++;
+	if (sim_enable) {
+		/* The simulator runs every transfer to completion */
+		async_tail = async_seq;
+		if (sim_bulk_transfer(WRITE_EP, x->wbuf, len) < 0 ||
+		    sim_bulk_transfer(WRITE_EP, ptr, CH341_PACKET_LENGTH) < 0 ||
+		    sim_bulk_transfer(READ_EP, x->rbuf, x->in_len) < (int)x->in_len) {
+			async_complete(x, ASYNC_ERR);
+			async_error = 1;
+			return -1;
+		}
+		async_complete(x, ASYNC_DONE);
+		return h;
+	}
+
+	x->out[0]->buffer = x->wbuf;
+	x->out[0]->length = len;
+	x->out[1]->buffer = ptr;
+	x->out[1]->length = CH341_PACKET_LENGTH;
+	for (j = 0; j < 2; j++) {
+		x->state_out[j] = TRANS_ACTIVE;
+		if (libusb_submit_transfer(x->out[j])) {
+			printf("%s: failed to submit OUT transfer\n", __func__);
+			x->state_out[j] = TRANS_ERR;
+			async_abort();
+			return -1;
+		}
+	}
+	if (async_pump(false) < 0)
+		return -1;
+
+	return h;
+}
+
+/* 1 - done, 0 - still on the wire, -1 - failed */
+int ch341a_spi_poll(int h)
+{
+	if (h < 0 || h >= async_seq)
+		return -1;
+	if (h >= async_tail && async_pump(false) < 0)
+		return -1;
+	if (h >= async_tail)
+		return 0;
+	/* Results of older handles are gone with their slot */
+	if (h < async_seq - CH341A_ASYNC_DEPTH)
+		return async_error ? -1 : 1;
+	return async_q[h % CH341A_ASYNC_DEPTH].state == ASYNC_DONE ? 1 : -1;
+}
+
+int ch341a_spi_wait(int h)
+{
+	int ret;
+
+	while ((ret = ch341a_spi_poll(h)) == 0)
+		if (async_pump(true) < 0)
+			return -1;
+	return ret < 0 ? -1 : 0;
+}
+
+int ch341a_spi_flush(void)
+{
+	int ret;
+
+	while (async_tail < async_seq)
+		if (async_pump(true) < 0)
+			break;
+	ret = async_error ? -1 : 0;
+	async_error = 0;
+	return ret;
+}
+
 int ch341a_spi_shutdown(void)
 {
 	if (handle == NULL)
 		return -1;
 
+	ch341a_spi_flush();
+	async_free();
 	enable_pins(false);
 	libusb_free_transfer(transfer_out);
 	transfer_out = NULL;
@@ -479,7 +818,7 @@ int ch341a_spi_init(void)
 	for (i = 0; i < USB_IN_TRANSFERS; i++)
 		libusb_fill_bulk_transfer(transfer_ins[i], handle, READ_EP, NULL, 0, cb_in, NULL, USB_TIMEOUT);
 
-	if ((config_stream(CH341A_STM_I2C_750K) < 0) || (enable_pins(true) < 0))
+	if ((config_stream(spi_speed) < 0) || (enable_pins(true) < 0))
 		goto dealloc_transfers;
 
 	return 0;
@@ -31,5 +31,26 @@ int ch341a_spi_send_command(unsigned int writecnt, unsigned int readcnt, const u
 int enable_pins(bool enable);
 int config_stream(unsigned int speed);
 
+/* Transactions queued on the wire at once by ch341a_spi_submit() */
+#define CH341A_ASYNC_DEPTH	4
+
+/*
+ * CS low, write, read, CS high without waiting for the USB round trip.
+ * Returns a handle for ch341a_spi_wait()/ch341a_spi_poll(), readarr is
+ * filled when the transaction completes. ch341a_spi_flush() waits for
+ * everything queued; blocking calls flush first, so the order on the wire
+ * is the call order.
+ */
+int ch341a_spi_submit(unsigned int writecnt, unsigned int readcnt, const unsigned char *writearr, unsigned char *readarr);
+int ch341a_spi_poll(int h);
+int ch341a_spi_wait(int h);
+int ch341a_spi_flush(void);
+
+/*
+ * Called before a SPI transaction starts and nothing is queued, a job on
+ * the I2C pins sends its next packets there. NULL - none.
+ */
+extern void (*ch341a_spi_idle)(void);
+
 #endif /* __CH341_SPI_H__ */
 /* End of [ch341a_spi.h] package */
@@ -0,0 +1,493 @@
+/*
+ * dumpdiff.c
+ *
+ * Offline bitflip analysis of repeated raw dumps of one SPI NAND. Every
+ * bit is voted over all dumps; a bit that is not the same in all of them
+ * is unstable, and each dump is charged with the bits it has against the
+ * majority. The XOR + popcount runs with AVX2 or NEON where the CPU has
+ * it, and blocks are spread over threads, so the dumps are read at disk
+ * speed.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DIFF_AVX2
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define DIFF_NEON
+#endif
+
+#include "dumpdiff.h"
+#include "flashcmd_api.h"
+#include "timer.h"
+
+#define DIFF_PLANES	5	/* vote counter bits, up to 31 dumps */
+#define DIFF_THREADS	16
+#define DIFF_BATCH	8	/* blocks a worker takes at a time */
+#define DIFF_HIST	16	/* unstable bits per page: 0, 1, 2-3, 4-7, ... */
+
+struct diff_block {
+	unsigned long data, oob;	/* unstable bits */
+	unsigned long pages;		/* pages with unstable bits */
+	unsigned long max;		/* most unstable bits in one page */
+};
+
+struct diff_worker {
+	pthread_t tid;
+	FILE *fp[DIFF_MAX], *best;
+	unsigned char *buf[DIFF_MAX], *vote, *mask, *zero;
+	unsigned long long flips[DIFF_MAX][2];	/* against the majority, data/OOB */
+	unsigned long hist[DIFF_HIST];
+	int err;
+};
+
+typedef unsigned long long (*diff_popcount_t)(const unsigned char *a, const unsigned char *b, unsigned long len);
+
+static struct {
+	char **name;
+	int n;
+	unsigned long page, oob, raw;	/* raw = page + oob as in the dump */
+	unsigned long pages;		/* per block */
+	unsigned long blocks;
+	const char *best;
+	struct diff_block *blk;
+	unsigned long next;		/* next block for the workers */
+	diff_popcount_t popcount;
+} dd;
+
+/* Bits set in a ^ b */
+static unsigned long long diff_popcount_c(const unsigned char *a, const unsigned char *b, unsigned long len)
+{
+	unsigned long long n = 0;
+	uint64_t x, y;
+	unsigned long i;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		memcpy(&x, a + i, 8);
+		memcpy(&y, b + i, 8);
+		n += __builtin_popcountll(x ^ y);
+	}
+	for (; i < len; i++)
+		n += __builtin_popcount(a[i] ^ b[i]);
+	return n;
+}
+
+#ifdef DIFF_AVX2
+/* Nibble lookup with vpshufb, bytes summed with vpsadbw */
+__attribute__((target("avx2")))
+static unsigned long long diff_popcount_avx2(const unsigned char *a, const unsigned char *b, unsigned long len)
+{
+	const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+					     0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low = _mm256_set1_epi8(0x0f), zero = _mm256_setzero_si256();
+	__m256i v, cnt, acc = zero;
+	unsigned long i;
+
+	for (i = 0; i + 32 <= len; i += 32) {
+		v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + i)),
+				     _mm256_loadu_si256((const __m256i *)(b + i)));
+		cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, low)),
+				      _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, zero));
+	}
+	return (unsigned long long)_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+	       _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3) +
+	       diff_popcount_c(a + i, b + i, len - i);
+}
+#endif
+
+#ifdef DIFF_NEON
+/* vcnt per byte, pairwise widened before the 16-bit lanes can overflow */
+static unsigned long long diff_popcount_neon(const unsigned char *a, const unsigned char *b, unsigned long len)
+{
+	uint64x2_t acc = vdupq_n_u64(0);
+	uint16x8_t sum;
+	unsigned long i = 0, n;
+
+	while (i + 16 <= len) {
+		sum = vdupq_n_u16(0);
+		for (n = 0; n < 2048 && i + 16 <= len; n++, i += 16)
+			sum = vpadalq_u8(sum, vcntq_u8(veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i))));
+		acc = vpadalq_u32(acc, vpaddlq_u16(sum));
+	}
+	return vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1) + diff_popcount_c(a + i, b + i, len - i);
+}
+#endif
+
+static const char *diff_kernel(void)
+{
+#ifdef DIFF_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		dd.popcount = diff_popcount_avx2;
+		return "AVX2";
+	}
+#endif
+#ifdef DIFF_NEON
+	dd.popcount = diff_popcount_neon;
+	return "NEON";
+#endif
+	dd.popcount = diff_popcount_c;
+	return "scalar";
+}
+
+/* Bit-sliced compare of the vote counters with t: count >= t, *eq count == t */
+static uint64_t diff_cmp(const uint64_t *c, unsigned int t, uint64_t *eq)
+{
+	uint64_t ge = 0, e = ~0ULL;
+	int k;
+
+	for (k = DIFF_PLANES - 1; k >= 0; k--) {
+		if (t >> k & 1) {
+			e &= c[k];
+		} else {
+			ge |= e & c[k];
+			e &= ~c[k];
+		}
+	}
+	*eq = e;
+	return ge | e;
+}
+
+/* Vote one word (len <= 8 bytes) at off; a tie of an even vote keeps dump 1 */
+static void diff_vote_word(struct diff_worker *w, unsigned long off, unsigned long len)
+{
+	uint64_t c[DIFF_PLANES] = { 0 }, d, d0 = 0, carry, t, any = 0, eq, v;
+	int i, k;
+
+	for (i = 0; i < dd.n; i++) {
+		d = 0;
+		memcpy(&d, w->buf[i] + off, len);
+		if (!i)
+			d0 = d;
+		for (k = 0, carry = d; k < DIFF_PLANES && carry; k++) {
+			t = c[k] & carry;
+			c[k] ^= carry;
+			carry = t;
+		}
+	}
+	for (k = 0; k < DIFF_PLANES; k++)
+		any |= c[k];
+
+	v = diff_cmp(c, dd.n / 2 + 1, &eq);
+	if (!(dd.n & 1)) {
+		diff_cmp(c, dd.n / 2, &eq);
+		v |= eq & d0;
+	}
+	memcpy(w->vote + off, &v, len);
+	diff_cmp(c, dd.n, &eq);
+	v = any & ~eq;
+	memcpy(w->mask + off, &v, len);
+}
+
+static void diff_page(struct diff_worker *w, unsigned long block, unsigned long page)
+{
+	struct diff_block *b = &dd.blk[block];
+	unsigned long o = page * dd.raw, data, oob, h;
+	int i;
+
+	data = dd.popcount(w->mask + o, w->zero, dd.page);
+	oob = dd.oob ? dd.popcount(w->mask + o + dd.page, w->zero, dd.oob) : 0;
+	for (h = 0; h < DIFF_HIST - 1 && (data + oob) >> h; h++)
+		;
+	w->hist[h]++;
+	if (!(data + oob))
+		return;
+
+	b->data += data;
+	b->oob += oob;
+	b->pages++;
+	if (data + oob > b->max)
+		b->max = data + oob;
+	for (i = 0; i < dd.n; i++) {
+		w->flips[i][0] += dd.popcount(w->buf[i] + o, w->vote + o, dd.page);
+		if (dd.oob)
+			w->flips[i][1] += dd.popcount(w->buf[i] + o + dd.page, w->vote + o + dd.page, dd.oob);
+	}
+}
+
+static void *diff_worker(void *arg)
+{
+	struct diff_worker *w = arg;
+	unsigned long bsize = dd.raw * dd.pages, first, last, b, off, p;
+	unsigned long long pos;
+	int i;
+
+	while ((first = __sync_fetch_and_add(&dd.next, DIFF_BATCH)) < dd.blocks) {
+		last = first + DIFF_BATCH < dd.blocks ? first + DIFF_BATCH : dd.blocks;
+		for (b = first; b < last; b++) {
+			pos = (unsigned long long)b * bsize;
+			for (i = 0; i < dd.n; i++) {
+				if (fseeko(w->fp[i], pos, SEEK_SET) || fread(w->buf[i], 1, bsize, w->fp[i]) != bsize) {
+					w->err = 1;
+					return NULL;
+				}
+			}
+			for (off = 0; off < bsize; off += 8)
+				diff_vote_word(w, off, bsize - off < 8 ? bsize - off : 8);
+			for (p = 0; p < dd.pages; p++)
+				diff_page(w, b, p);
+			if (w->best && (fseeko(w->best, pos, SEEK_SET) || fwrite(w->vote, 1, bsize, w->best) != bsize)) {
+				w->err = 1;
+				return NULL;
+			}
+		}
+	}
+	return NULL;
+}
+
+static int diff_worker_open(struct diff_worker *w)
+{
+	unsigned long bsize = dd.raw * dd.pages;
+	int i;
+
+	for (i = 0; i < dd.n; i++)
+		if (!(w->fp[i] = fopen(dd.name[i], "rb")) || !(w->buf[i] = malloc(bsize)))
+			return -1;
+	if (dd.best && !(w->best = fopen(dd.best, "r+b")))
+		return -1;
+	w->vote = malloc(bsize);
+	w->mask = malloc(bsize);
+	w->zero = calloc(dd.raw, 1);
+	return w->vote && w->mask && w->zero ? 0 : -1;
+}
+
+static void diff_worker_close(struct diff_worker *w)
+{
+	int i;
+
+	for (i = 0; i < dd.n; i++) {
+		if (w->fp[i])
+			fclose(w->fp[i]);
+		free(w->buf[i]);
+	}
+	if (w->best)
+		fclose(w->best);
+	free(w->vote);
+	free(w->mask);
+	free(w->zero);
+}
+
+static int diff_threads(void)
+{
+	long n = 4;
+
+#ifdef _SC_NPROCESSORS_ONLN
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (n < 1)
+		n = 1;
+	if (n > DIFF_THREADS)
+		n = DIFF_THREADS;
+	if (n > (dd.blocks + DIFF_BATCH - 1) / DIFF_BATCH)
+		n = (dd.blocks + DIFF_BATCH - 1) / DIFF_BATCH;
+	return n;
+}
+
+static unsigned long long diff_size(const char *name)
+{
+	unsigned long long size = 0;
+	FILE *fp;
+
+	if (!(fp = fopen(name, "rb"))) {
+		printf("Couldn't open file %s for reading.\n", name);
+		return 0;
+	}
+	if (!fseeko(fp, 0, SEEK_END))
+		size = ftello(fp);
+	fclose(fp);
+	return size;
+}
+
+/*
+ * Raw -d dumps carry the OOB after every page, plain dumps only the data.
+ * With -d the dumps are raw, else a size is only taken as raw when it is
+ * the whole chip with OOB or no whole number of plain blocks.
+ */
+static int diff_geometry(const struct snand_geometry *geo, unsigned long long size, int oob)
+{
+	unsigned long long raw_block, data_block;
+
+	dd.pages = geo->erase_size / geo->page_size;
+	raw_block = (unsigned long long)(geo->page_size + geo->oob_size) * dd.pages;
+	data_block = (unsigned long long)geo->erase_size;
+	dd.page = geo->page_size;
+
+	if (oob || size == geo->size / data_block * raw_block || (size % raw_block == 0 && size % data_block)) {
+		if (size % raw_block) {
+			printf("Dump size %llu is not a whole number of %s blocks with OOB.\n", size, geo->name);
+			return -1;
+		}
+		dd.oob = geo->oob_size;
+		dd.blocks = size / raw_block;
+		printf("Dumps are raw with OOB (%s), data and OOB are compared.\n", oob ? "-d" : "by size");
+	} else if (size % data_block == 0) {
+		dd.oob = 0;
+		dd.blocks = size / data_block;
+		printf("Dumps have no OOB (read without -d), only the data area is compared.\n");
+	} else {
+		printf("Dump size %llu is not a whole number of %s blocks.\n", size, geo->name);
+		return -1;
+	}
+	dd.raw = dd.page + dd.oob;
+	return 0;
+}
+
+static void diff_report(struct diff_worker *w, int nthreads)
+{
+	unsigned long long flips[DIFF_MAX][2] = { { 0 } }, data = 0, oob = 0;
+	unsigned long hist[DIFF_HIST] = { 0 }, pages = 0, blocks = 0, b;
+	int i, t;
+
+	for (t = 0; t < nthreads; t++) {
+		for (i = 0; i < dd.n; i++) {
+			flips[i][0] += w[t].flips[i][0];
+			flips[i][1] += w[t].flips[i][1];
+		}
+		for (i = 0; i < DIFF_HIST; i++)
+			hist[i] += w[t].hist[i];
+	}
+
+	for (b = 0; b < dd.blocks; b++) {
+		if (!dd.blk[b].pages)
+			continue;
+		if (!blocks++)
+			printf("Block   Offset        Pages  Data bits  OOB bits  Max/page\n");
+		printf("%-7lu 0x%010llx  %-6lu %-10lu %-9lu %lu\n", b,
+			(unsigned long long)b * dd.raw * dd.pages, dd.blk[b].pages,
+			dd.blk[b].data, dd.blk[b].oob, dd.blk[b].max);
+		data += dd.blk[b].data;
+		oob += dd.blk[b].oob;
+		pages += dd.blk[b].pages;
+	}
+
+	printf("Unstable bits per page:\n");
+	for (i = 0; i < DIFF_HIST; i++) {
+		if (!hist[i])
+			continue;
+		if (i < 2)
+			printf("  %-12d %lu pages\n", i, hist[i]);
+		else if (i < DIFF_HIST - 1)
+			printf("  %lu-%-10lu %lu pages\n", 1UL << (i - 1), (1UL << i) - 1, hist[i]);
+		else
+			printf("  %lu+%-10s %lu pages\n", 1UL << (i - 1), "", hist[i]);
+	}
+	for (i = 0; i < dd.n; i++)
+		printf("Dump %d %s: %llu data + %llu OOB bits differ from the majority\n",
+			i + 1, dd.name[i], flips[i][0], flips[i][1]);
+	printf("Unstable: %llu data + %llu OOB bits in %lu pages of %lu blocks\n", data, oob, pages, blocks);
+}
+
+int diff_run(char **dumps, int n, const char *chip, const char *best, int oob)
+{
+	struct snand_geometry geo;
+	struct diff_worker *w = NULL;
+	unsigned long long size = 0, s, start;
+	const char *kernel;
+	int i, nthreads = 0, nworkers = 0, ret = -1;
+	FILE *fp;
+
+	if (n < 2 || n > DIFF_MAX) {
+		printf("Dump compare needs 2 to %d dumps.\n", DIFF_MAX);
+		return -1;
+	}
+	if (!chip) {
+		printf("Chip for the dump geometry is not set, use --chip.\n");
+		return -1;
+	}
+	if (snand_geometry(chip, &geo) < 0)
+		return -1;
+
+	memset(&dd, 0, sizeof(dd));
+	dd.name = dumps;
+	dd.n = n;
+	dd.best = best;
+	for (i = 0; i < n; i++) {
+		if (!(s = diff_size(dumps[i])))
+			return -1;
+		if (size && s != size)
+			printf("Dumps differ in size, only the first %llu bytes are compared.\n", s < size ? s : size);
+		if (!size || s < size)
+			size = s;
+	}
+	if (diff_geometry(&geo, size, oob) < 0)
+		return -1;
+
+	if (best) {
+		/* Workers write their blocks in place */
+		if (!(fp = fopen(best, "wb")) || fseeko(fp, (unsigned long long)dd.blocks * dd.raw * dd.pages - 1, SEEK_SET) ||
+		    fputc(0xff, fp) == EOF || fclose(fp)) {
+			printf("Couldn't open file %s for writing.\n", best);
+			return -1;
+		}
+	}
+
+	kernel = diff_kernel();
+	nworkers = nthreads = diff_threads();
+	dd.blk = calloc(dd.blocks, sizeof(*dd.blk));
+	w = calloc(nworkers, sizeof(*w));
+	if (!dd.blk || !w) {
+		printf("Malloc failed for dump compare.\n");
+		goto out;
+	}
+	for (i = 0; i < nworkers; i++) {
+		if (diff_worker_open(&w[i]) < 0) {
+			printf("Couldn't set up dump compare.\n");
+			goto out;
+		}
+	}
+
+	printf("DIFF: %d dumps of %s, %lu blocks x %lu pages of %lu + %lu bytes, %s, %d threads\n",
+		n, geo.name, dd.blocks, dd.pages, dd.page, dd.oob, kernel, nthreads);
+	start = timer_usec();
+	for (i = 0; i < nthreads; i++) {
+		if (pthread_create(&w[i].tid, NULL, diff_worker, &w[i])) {
+			nthreads = i;
+			printf("Couldn't start dump compare thread.\n");
+			break;
+		}
+	}
+	for (i = 0; i < nthreads; i++) {
+		pthread_join(w[i].tid, NULL);
+		if (w[i].err) {
+			printf("Error reading dumps or writing %s\n", best ? best : "");
+			goto out;
+		}
+	}
+	if (dd.next < dd.blocks)
+		goto out;
+	s = timer_usec() - start;
+
+	diff_report(w, nthreads);
+	size = (unsigned long long)dd.blocks * dd.raw * dd.pages * n;
+	printf("Compared %llu MB in %llu.%03llu s", size >> 20, s / 1000000, s / 1000 % 1000);
+	if (s)
+		printf(", %llu MB/s", size * 1000000 / s >> 20);
+	printf("\n");
+	if (best)
+		printf("Majority image written to %s\n", best);
+	ret = 0;
+out:
+	for (i = 0; w && i < nworkers; i++)
+		diff_worker_close(&w[i]);
+	free(w);
+	free(dd.blk);
+	return ret;
+}
+/* End of [dumpdiff.c] package */
@@ -0,0 +1,28 @@
+/*
+ * dumpdiff.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __DUMPDIFF_H__
+#define __DUMPDIFF_H__
+
+#define DIFF_MAX	16	/* dumps of one chip */
+
+/*
+ * Compare raw dumps of one SPI NAND (chip is a table name), report the
+ * unstable bits per page, block and dump, and optionally write the
+ * majority voted image to best. With oob the dumps are raw -d dumps,
+ * else the format follows from the size. No programmer is needed.
+ */
+int diff_run(char **dumps, int n, const char *chip, const char *best, int oob);
+
+#endif /* __DUMPDIFF_H__ */
+/* End of [dumpdiff.h] package */
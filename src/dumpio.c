@@ -0,0 +1,561 @@
+/*
+ * dumpio.c
+ *
+ * File side of dumps and images past the page cache. A dump is read from
+ * the chip a chunk at a time into one of a few aligned buffers, each chunk
+ * is queued to the file as soon as it is in and the chip goes on with the
+ * next one, so host memory stays at the buffers whatever the chip size and
+ * a slow disk does not stall the USB pipeline until all buffers are taken.
+ * The file is opened with O_DIRECT where the filesystem allows it and the
+ * chunks go through an io_uring submission queue, set up with the raw
+ * system calls. Without io_uring (old kernel, seccomp, not Linux) worker
+ * threads do pwrite/pread, without O_DIRECT they write back each chunk
+ * and drop it from the page cache.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#define _GNU_SOURCE	/* O_DIRECT, sync_file_range */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "dumpio.h"
+#include "timer.h"
+
+#define DIO_CHUNK	(1024 * 1024)
+#define DIO_DEPTH	4	/* chunks in flight */
+#define DIO_THREADS	2
+#define DIO_ALIGN	4096	/* O_DIRECT buffer, offset and length */
+
+#ifndef O_BINARY
+#define O_BINARY	0
+#endif
+
+enum { DIO_BEST, DIO_URING, DIO_THREADS_ONLY };
+enum { DIO_FREE, DIO_QUEUED, DIO_DONE };
+
+struct dio_slot {
+	unsigned char *buf, *mem;	/* aligned, as allocated */
+	unsigned long long off;
+	unsigned long len;		/* bytes of the transfer, aligned with O_DIRECT */
+	unsigned long want;		/* bytes of the file in it */
+	unsigned long done;
+	unsigned char *dst;		/* load: where the bytes go */
+	long res;
+	int state;
+#ifdef __linux__
+	struct iovec iov;
+#endif
+};
+
+static struct {
+	int backend;
+	int fd, write, direct, uring;
+	struct dio_slot slot[DIO_DEPTH];
+	int error;
+	unsigned long long stall;	/* usec the chip side waited for a buffer */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t tid[DIO_THREADS];
+	int nthreads, quit;
+	struct dio_slot *queue[DIO_DEPTH];
+	unsigned qhead, qtail;
+#ifdef _WIN32
+	pthread_mutex_t seek;		/* no pwrite, lseek and write go together */
+#endif
+} dio = { DIO_BEST };
+
+int dio_parse(const char *s)
+{
+	if (!s)
+		dio.backend = DIO_BEST;
+	else if (!strcmp(s, "uring"))
+		dio.backend = DIO_URING;
+	else if (!strcmp(s, "threads"))
+		dio.backend = DIO_THREADS_ONLY;
+	else {
+		printf("Unknown direct I/O backend %s, use uring or threads.\n", s);
+		return -1;
+	}
+	return 0;
+}
+
+#ifdef __linux__
+static struct {
+	int fd;
+	unsigned *sq_tail, *sq_mask, *sq_array, *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq, *cq;
+	size_t sq_len, cq_len, sqes_len;
+} ring = { -1 };
+
+static void dio_uring_free(void)
+{
+	if (ring.sqes && ring.sqes != MAP_FAILED)
+		munmap(ring.sqes, ring.sqes_len);
+	if (ring.cq && ring.cq != MAP_FAILED && ring.cq != ring.sq)
+		munmap(ring.cq, ring.cq_len);
+	if (ring.sq && ring.sq != MAP_FAILED)
+		munmap(ring.sq, ring.sq_len);
+	if (ring.fd >= 0)
+		close(ring.fd);
+	memset(&ring, 0, sizeof(ring));
+	ring.fd = -1;
+}
+
+static int dio_uring_setup(void)
+{
+	struct io_uring_params p;
+	char *sq, *cq;
+
+	memset(&p, 0, sizeof(p));
+	if ((ring.fd = syscall(__NR_io_uring_setup, DIO_DEPTH, &p)) < 0)
+		return -1;
+	ring.sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ring.cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring.cq_len > ring.sq_len)
+			ring.sq_len = ring.cq_len;
+		ring.cq_len = ring.sq_len;
+	}
+	ring.sq = mmap(NULL, ring.sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+	if (ring.sq == MAP_FAILED)
+		goto fail;
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		ring.cq = ring.sq;
+	else if ((ring.cq = mmap(NULL, ring.cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				ring.fd, IORING_OFF_CQ_RING)) == MAP_FAILED)
+		goto fail;
+	ring.sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+	ring.sqes = mmap(NULL, ring.sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+	if (ring.sqes == MAP_FAILED)
+		goto fail;
+
+	sq = ring.sq;
+	cq = ring.cq;
+	ring.sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	ring.sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+	ring.sq_array = (unsigned *)(sq + p.sq_off.array);
+	ring.cq_head = (unsigned *)(cq + p.cq_off.head);
+	ring.cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	ring.cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+	ring.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+	return 0;
+fail:
+	dio_uring_free();
+	return -1;
+}
+
+static int dio_uring_submit(struct dio_slot *s)
+{
+	unsigned tail = *ring.sq_tail, i = tail & *ring.sq_mask;
+	struct io_uring_sqe *e = &ring.sqes[i];
+
+	s->iov.iov_base = s->buf + s->done;
+	s->iov.iov_len = s->len - s->done;
+	memset(e, 0, sizeof(*e));
+	e->opcode = dio.write ? IORING_OP_WRITEV : IORING_OP_READV;
+	e->fd = dio.fd;
+	e->addr = (uintptr_t)&s->iov;
+	e->len = 1;
+	e->off = s->off + s->done;
+	e->user_data = s - dio.slot;
+	ring.sq_array[i] = i;
+	__atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+	return syscall(__NR_io_uring_enter, ring.fd, 1, 0, 0, NULL, 0) == 1 ? 0 : -1;
+}
+
+/* Take the completions in, wait for one first */
+static int dio_uring_reap(void)
+{
+	unsigned head;
+	struct io_uring_cqe *c;
+	struct dio_slot *s;
+
+	if (syscall(__NR_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+		return -1;
+	head = *ring.cq_head;
+	while (head != __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+		c = &ring.cqes[head & *ring.cq_mask];
+		s = &dio.slot[c->user_data];
+		if (c->res < 0) {
+			s->res = -1;
+			s->state = DIO_DONE;
+		} else {
+			s->done += c->res;
+			if (c->res && s->done < s->len) {
+				/* Short transfer, the rest goes again */
+				__atomic_store_n(ring.cq_head, ++head, __ATOMIC_RELEASE);
+				if (dio_uring_submit(s) < 0) {
+					s->res = -1;
+					s->state = DIO_DONE;
+				}
+				continue;
+			}
+			s->res = s->done;
+			s->state = DIO_DONE;
+		}
+		__atomic_store_n(ring.cq_head, ++head, __ATOMIC_RELEASE);
+	}
+	return 0;
+}
+#endif
+
+/* One whole slot with pwrite/pread, 0 at the end of the file */
+static long dio_pio(struct dio_slot *s)
+{
+	long r;
+
+	while (s->done < s->len) {
+#ifdef _WIN32
+		pthread_mutex_lock(&dio.seek);
+		if (lseek(dio.fd, s->off + s->done, SEEK_SET) < 0)
+			r = -1;
+		else if (dio.write)
+			r = write(dio.fd, s->buf + s->done, s->len - s->done);
+		else
+			r = read(dio.fd, s->buf + s->done, s->len - s->done);
+		pthread_mutex_unlock(&dio.seek);
+#else
+		if (dio.write)
+			r = pwrite(dio.fd, s->buf + s->done, s->len - s->done, s->off + s->done);
+		else
+			r = pread(dio.fd, s->buf + s->done, s->len - s->done, s->off + s->done);
+#endif
+		if (r < 0 && errno != EINTR)
+			return -1;
+		if (!r)
+			break;
+		if (r > 0)
+			s->done += r;
+	}
+	/* Through the page cache the chunk is written back and dropped */
+#ifdef __linux__
+	if (!dio.direct && dio.write && s->done)
+		sync_file_range(dio.fd, s->off, s->done,
+			SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+#endif
+#ifdef POSIX_FADV_DONTNEED
+	if (!dio.direct && s->done)
+		posix_fadvise(dio.fd, s->off, s->done, POSIX_FADV_DONTNEED);
+#endif
+	return s->done;
+}
+
+static void *dio_worker(void *arg)
+{
+	struct dio_slot *s;
+	long r;
+
+	pthread_mutex_lock(&dio.lock);
+	for (;;) {
+		while (!dio.quit && dio.qhead == dio.qtail)
+			pthread_cond_wait(&dio.cond, &dio.lock);
+		if (dio.qhead == dio.qtail)
+			break;
+		s = dio.queue[dio.qhead++ % DIO_DEPTH];
+		pthread_mutex_unlock(&dio.lock);
+		r = dio_pio(s);
+		pthread_mutex_lock(&dio.lock);
+		s->res = r;
+		s->state = DIO_DONE;
+		pthread_cond_broadcast(&dio.cond);
+	}
+	pthread_mutex_unlock(&dio.lock);
+	return NULL;
+}
+
+static int dio_start(struct dio_slot *s)
+{
+	s->state = DIO_QUEUED;
+	s->done = 0;
+#ifdef __linux__
+	if (dio.uring)
+		return dio_uring_submit(s);
+#endif
+	pthread_mutex_lock(&dio.lock);
+	dio.queue[dio.qtail++ % DIO_DEPTH] = s;
+	pthread_cond_broadcast(&dio.cond);
+	pthread_mutex_unlock(&dio.lock);
+	return 0;
+}
+
+/* Wait for the slot to complete and hand its bytes over, the slot is free after */
+static int dio_retire(struct dio_slot *s)
+{
+	unsigned long long t = timer_usec();
+	unsigned long n;
+
+	if (s->state == DIO_FREE)
+		return 0;
+#ifdef __linux__
+	if (dio.uring) {
+		while (s->state == DIO_QUEUED)
+			if (dio_uring_reap() < 0) {
+				s->res = -1;
+				break;
+			}
+	} else
+#endif
+	{
+		pthread_mutex_lock(&dio.lock);
+		while (s->state == DIO_QUEUED)
+			pthread_cond_wait(&dio.cond, &dio.lock);
+		pthread_mutex_unlock(&dio.lock);
+	}
+	dio.stall += timer_usec() - t;
+	s->state = DIO_FREE;
+
+	if (s->res < 0 || (dio.write && s->res < s->len)) {
+		if (!dio.error)
+			printf("Error %s file at 0x%llX\n", dio.write ? "writing" : "reading", s->off);
+		dio.error = 1;
+		return -1;
+	}
+	if (!dio.write) {
+		n = s->res < s->want ? s->res : s->want;
+		memcpy(s->dst, s->buf, n);
+	}
+	return 0;
+}
+
+static unsigned long dio_len(unsigned long n)
+{
+	return dio.direct ? (n + DIO_ALIGN - 1) / DIO_ALIGN * DIO_ALIGN : n;
+}
+
+static int dio_open(const char *name, int write)
+{
+	int flags = (write ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY) | O_BINARY, i;
+	const char *how = "page cache dropped per chunk";
+
+	memset(&dio.slot, 0, sizeof(dio.slot));
+	dio.write = write;
+	dio.direct = dio.uring = dio.error = 0;
+	dio.nthreads = dio.quit = 0;
+	dio.qhead = dio.qtail = 0;
+	dio.stall = 0;
+
+	dio.fd = -1;
+#ifdef O_DIRECT
+	/* Some filesystems (tmpfs) refuse O_DIRECT */
+	if ((dio.fd = open(name, flags | O_DIRECT, 0644)) >= 0) {
+		dio.direct = 1;
+		how = "O_DIRECT";
+	}
+#endif
+	if (dio.fd < 0 && (dio.fd = open(name, flags, 0644)) < 0) {
+		printf("Couldn't open file %s for %s.\n", name, write ? "writing" : "reading");
+		return -1;
+	}
+#ifdef F_NOCACHE
+	if (!fcntl(dio.fd, F_NOCACHE, 1))
+		how = "F_NOCACHE";
+#endif
+
+	for (i = 0; i < DIO_DEPTH; i++) {
+		if (!(dio.slot[i].mem = malloc(DIO_CHUNK + DIO_ALIGN))) {
+			printf("Malloc failed for direct I/O buffers.\n");
+			goto fail;
+		}
+		dio.slot[i].buf = (unsigned char *)(((uintptr_t)dio.slot[i].mem + DIO_ALIGN - 1) & ~(uintptr_t)(DIO_ALIGN - 1));
+	}
+
+#ifdef __linux__
+	/* Through the page cache io_uring would block in the submit, threads do it */
+	if (dio.backend != DIO_THREADS_ONLY && dio.direct && !dio_uring_setup())
+		dio.uring = 1;
+#endif
+	if (dio.backend == DIO_URING && !dio.uring)
+		printf("io_uring is not available, using threads.\n");
+	if (!dio.uring) {
+		pthread_mutex_init(&dio.lock, NULL);
+		pthread_cond_init(&dio.cond, NULL);
+#ifdef _WIN32
+		pthread_mutex_init(&dio.seek, NULL);
+#endif
+		for (i = 0; i < DIO_THREADS; i++, dio.nthreads++)
+			if (pthread_create(&dio.tid[i], NULL, dio_worker, NULL)) {
+				if (!i) {
+					printf("Couldn't start direct I/O thread.\n");
+					goto fail;
+				}
+				break;
+			}
+	}
+	printf("Direct I/O: %s, %s, %d buffers of %d KB\n", dio.uring ? "io_uring" :
+		write ? "pwrite threads" : "pread threads", how, DIO_DEPTH, DIO_CHUNK / 1024);
+	return 0;
+fail:
+	for (i = 0; i < DIO_DEPTH; i++)
+		free(dio.slot[i].mem);
+	close(dio.fd);
+	return -1;
+}
+
+/* Finish what is queued, the file gets its real size. Returns 0 or -1 */
+static int dio_close(unsigned long long size)
+{
+	int i;
+
+	for (i = 0; i < DIO_DEPTH; i++)
+		dio_retire(&dio.slot[i]);
+	if (dio.uring) {
+#ifdef __linux__
+		dio_uring_free();
+#endif
+	} else {
+		pthread_mutex_lock(&dio.lock);
+		dio.quit = 1;
+		pthread_cond_broadcast(&dio.cond);
+		pthread_mutex_unlock(&dio.lock);
+		for (i = 0; i < dio.nthreads; i++)
+			pthread_join(dio.tid[i], NULL);
+	}
+	/* O_DIRECT wrote the last chunk padded */
+	if (dio.write && dio.direct && ftruncate(dio.fd, size) < 0 && !dio.error) {
+		printf("Error writing file at 0x%llX\n", size);
+		dio.error = 1;
+	}
+	if (close(dio.fd) < 0 && !dio.error) {
+		printf("Error writing file at 0x%llX\n", size);
+		dio.error = 1;
+	}
+	for (i = 0; i < DIO_DEPTH; i++)
+		free(dio.slot[i].mem);
+	return dio.error ? -1 : 0;
+}
+
+static void dio_progress(unsigned long long done, unsigned long long total, unsigned long long *last)
+{
+	if (timer_usec() - *last < 1000000)
+		return;
+	printf("\bRead %d%% [%llu] of [%llu] bytes      ", timer_percent(done, total), done, total);
+	printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+	fflush(stdout);
+	*last = timer_usec();
+}
+
+int dio_dump(struct flash_cmd *cmd, const char *name, unsigned long long addr, unsigned long long len)
+{
+	unsigned long long off, start, last = 0;
+	unsigned char *whole = NULL;
+	struct flash_info info;
+	struct dio_slot *s;
+	unsigned long n, k;
+	int ret = 0;
+
+	memset(&info, 0, sizeof(info));
+	if (cmd->flash_info)
+		cmd->flash_info(&info);
+	if (dio_open(name, 1) < 0)
+		return -1;
+
+	/* A chip that always sends all of it is read once, the chunks go from memory */
+	if (info.whole_chip) {
+		if (!(whole = malloc(len))) {
+			printf("Malloc failed for read buffer.\n");
+			dio_close(0);
+			return -1;
+		}
+		if (cmd->flash_read(whole, addr, len) < 0)
+			ret = -1;
+	}
+
+	start = timer_usec();
+	for (off = 0, k = 0; !ret && off < len; off += n, k++) {
+		s = &dio.slot[k % DIO_DEPTH];
+		if (dio_retire(s) < 0) {
+			ret = -1;
+			break;
+		}
+		n = len - off < DIO_CHUNK ? len - off : DIO_CHUNK;
+		if (whole) {
+			memcpy(s->buf, whole + off, n);
+		} else {
+			timer_mute(1);
+			if (cmd->flash_read(s->buf, addr + off, n) < 0)
+				ret = -1;
+			timer_mute(0);
+			if (ret)
+				break;
+		}
+		s->off = off;
+		s->want = n;
+		s->len = dio_len(n);
+		memset(s->buf + n, 0, s->len - n);
+		if (dio_start(s) < 0) {
+			printf("Error writing file at 0x%llX\n", off);
+			s->state = DIO_FREE;
+			ret = -1;
+		}
+		dio_progress(off + n, len, &last);
+	}
+	if (dio_close(len) < 0)
+		ret = -1;
+	free(whole);
+	if (!ret) {
+		printf("Read 100%% [%llu] of [%llu] bytes      \n", len, len);
+		printf("Elapsed time: %d seconds\n", (int)((timer_usec() - start) / 1000000));
+	}
+	printf("Direct I/O: %llu ms waiting for the file\n", dio.stall / 1000);
+	return ret;
+}
+
+long long dio_load(const char *name, unsigned char *buf, unsigned long long len)
+{
+	unsigned long long off;
+	struct dio_slot *s;
+	struct stat st;
+	unsigned long n, k;
+
+	if (dio_open(name, 0) < 0)
+		return -1;
+	if (!fstat(dio.fd, &st) && (unsigned long long)st.st_size < len)
+		len = st.st_size;
+
+	for (off = 0, k = 0; off < len; off += n, k++) {
+		s = &dio.slot[k % DIO_DEPTH];
+		if (dio_retire(s) < 0)
+			break;
+		n = len - off < DIO_CHUNK ? len - off : DIO_CHUNK;
+		s->off = off;
+		s->want = n;
+		s->len = dio_len(n);
+		s->dst = buf + off;
+		if (dio_start(s) < 0) {
+			printf("Error reading file at 0x%llX\n", off);
+			s->state = DIO_FREE;
+			dio.error = 1;
+			break;
+		}
+	}
+	if (dio_close(len) < 0)
+		return -1;
+	return len;
+}
+/* End of [dumpio.c] package */
@@ -0,0 +1,33 @@
+/*
+ * dumpio.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __DUMPIO_H__
+#define __DUMPIO_H__
+
+#include "flashcmd_api.h"
+
+/* Parse the --direct backend: NULL - best, "uring" or "threads". Returns 0 or -1 */
+int dio_parse(const char *s);
+
+/*
+ * Read len bytes at addr of the chip to file name a chunk at a time, each
+ * chunk is queued to the file as soon as the chip returned it and only a
+ * few chunk buffers are in use. Returns 0 or -1.
+ */
+int dio_dump(struct flash_cmd *cmd, const char *name, unsigned long long addr, unsigned long long len);
+
+/* Load up to len bytes of file name into buf past the page cache. Returns the bytes or -1 */
+long long dio_load(const char *name, unsigned char *buf, unsigned long long len);
+
+#endif /* __DUMPIO_H__ */
+/* End of [dumpio.h] package */
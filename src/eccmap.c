@@ -0,0 +1,319 @@
+/*
+ * eccmap.c
+ *
+ * NAND ECC mode per region in one pass. SoC boot blocks often carry their
+ * own ECC in the OOB and must be read and written raw, the rest of the chip
+ * uses on-die ECC. Each region is ecc (data), raw (data with on-die ECC
+ * off, OOB left alone) or raw+oob (page and OOB as with -d), the image is
+ * the regions one after another in chip order. The driver switches ECC
+ * only where a transfer crosses into a region of another mode.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "eccmap.h"
+#include "timer.h"
+
+enum { EM_ECC, EM_RAW, EM_RAW_OOB };
+
+static const char *em_names[] = { "ecc", "raw", "raw+oob" };
+
+struct em_seg {
+	unsigned long first, blocks;	/* chip blocks */
+	int mode;
+	unsigned long long lstart, lsize;	/* image bytes */
+};
+
+static struct {
+	struct flash_cmd *cmd;
+	struct flash_cmd orig;
+	struct snand_geometry geo;	/* without the OOB */
+	unsigned long ppb, rpage;	/* pages per block, page + OOB bytes */
+	int def_ecc;
+	struct em_seg *s;		/* sorted, the whole chip */
+	int nsegs;
+	unsigned long long size;
+	unsigned char *scratch;		/* one raw block */
+	unsigned long switches;
+} em;
+
+/* Image bytes of a block */
+static unsigned long em_unit(int mode)
+{
+	return mode == EM_RAW_OOB ? em.ppb * em.rpage : em.geo.erase_size;
+}
+
+/* Chip bytes of a block in the driver geometry of the mode */
+static unsigned long em_chip_unit(int mode)
+{
+	return mode == EM_ECC ? em.geo.erase_size : em.ppb * em.rpage;
+}
+
+static void em_mode(int mode)
+{
+	if ((mode == EM_ECC) != ECC_fcheck)
+		em.switches++;
+	snand_ecc_mode(mode == EM_ECC);
+}
+
+/* Segment holding image offset off */
+static struct em_seg *em_find(unsigned long long off)
+{
+	int lo = 0, hi = em.nsegs - 1, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (em.s[mid].lstart <= off)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return &em.s[lo];
+}
+
+/* Data bytes o..o+n of a raw segment inside one block, the OOB of the pages is kept */
+static long long em_raw(struct em_seg *s, unsigned char *buf, unsigned long long o, unsigned long n, int write)
+{
+	unsigned long page = em.geo.page_size, p0 = o / page, p1 = (o + n + page - 1) / page;
+	unsigned long long addr = ((unsigned long long)s->first * em.ppb + p0) * em.rpage, pos;
+	unsigned long len = (p1 - p0) * em.rpage, k, col;
+	unsigned char *r;
+
+	if (!write || o % page || (o + n) % page) {
+		if (em.orig.flash_read(em.scratch, addr, len) < 0)
+			return -1;
+	} else {
+		memset(em.scratch, 0xff, len);
+	}
+	for (pos = o; pos < o + n; pos += k) {
+		col = pos % page;
+		k = page - col < o + n - pos ? page - col : o + n - pos;
+		r = em.scratch + (pos / page - p0) * em.rpage + col;
+		if (write)
+			memcpy(r, buf + (pos - o), k);
+		else
+			memcpy(buf + (pos - o), r, k);
+	}
+	if (write && em.orig.flash_write(em.scratch, addr, len) < 0)
+		return -1;
+	return n;
+}
+
+static long long em_xfer(unsigned char *buf, unsigned long long from, unsigned long long len, int write)
+{
+	unsigned long long done, o, n;
+	struct em_seg *s;
+	long long r;
+
+	if (from > em.size || len > em.size - from) {
+		printf("%s 0x%llX bytes at 0x%016llX is past the end of the image\n", write ? "Write" : "Read", len, from);
+		return -1;
+	}
+	for (done = 0; done < len; done += n) {
+		s = em_find(from + done);
+		o = from + done - s->lstart;
+		n = len - done < s->lsize - o ? len - done : s->lsize - o;
+		em_mode(s->mode);
+		if (s->mode == EM_RAW) {
+			/* A block at a time through the scratch buffer */
+			if (n > em.geo.erase_size - o % em.geo.erase_size)
+				n = em.geo.erase_size - o % em.geo.erase_size;
+			timer_mute(1);
+			r = em_raw(s, buf + done, o, n, write);
+			timer_mute(0);
+		} else if (write) {
+			r = em.orig.flash_write(buf + done, (unsigned long long)s->first * em_chip_unit(s->mode) + o, n);
+		} else {
+			r = em.orig.flash_read(buf + done, (unsigned long long)s->first * em_chip_unit(s->mode) + o, n);
+		}
+		if (r < 0)
+			return -1;
+	}
+	return len;
+}
+
+static long long em_read(unsigned char *buf, unsigned long long from, unsigned long long len)
+{
+	return em_xfer(buf, from, len, 0);
+}
+
+static long long em_write(unsigned char *buf, unsigned long long to, unsigned long long len)
+{
+	return em_xfer(buf, to, len, 1);
+}
+
+static int em_erase(unsigned long long offs, unsigned long long len)
+{
+	unsigned long long done, o, n, unit;
+	struct em_seg *s;
+
+	if (offs > em.size || len > em.size - offs) {
+		printf("Erase 0x%llX bytes at 0x%016llX is past the end of the image\n", len, offs);
+		return -1;
+	}
+	for (done = 0; done < len; done += n) {
+		s = em_find(offs + done);
+		o = offs + done - s->lstart;
+		n = len - done < s->lsize - o ? len - done : s->lsize - o;
+		unit = em_unit(s->mode);
+		if (o % unit || n % unit) {
+			printf("Erase at 0x%016llX is not whole blocks of 0x%llX bytes of its %s region\n",
+				offs + done, unit, em_names[s->mode]);
+			return -1;
+		}
+		em_mode(s->mode);
+		if (em.orig.flash_erase((s->first + o / unit) * em_chip_unit(s->mode), n / unit * em_chip_unit(s->mode)) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+struct em_region {
+	unsigned long long addr, len;
+	int mode;
+};
+
+static int em_region_cmp(const void *a, const void *b)
+{
+	const struct em_region *x = a, *y = b;
+
+	return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+static int em_parse(const char *spec, struct em_region *r)
+{
+	char *end;
+	int i;
+
+	r->addr = strtoull(spec, &end, 0);
+	if (*end == ':')
+		r->len = strtoull(end + 1, &end, 0);
+	if (end == spec || *end++ != ':')
+		goto bad;
+	for (i = 0; i < sizeof(em_names) / sizeof(em_names[0]); i++)
+		if (!strcmp(end, em_names[i]))
+			break;
+	if (i == sizeof(em_names) / sizeof(em_names[0]))
+		goto bad;
+	r->mode = i;
+	if (!r->len || r->addr % em.geo.erase_size || r->len % em.geo.erase_size ||
+	    r->addr > em.geo.size || r->len > em.geo.size - r->addr) {
+		printf("ECC region %s must be whole blocks of 0x%lX bytes inside the chip\n", spec, em.geo.erase_size);
+		return -1;
+	}
+	return 0;
+bad:
+	printf("ECC region %s is not <addr>:<len>:<ecc|raw|raw+oob>\n", spec);
+	return -1;
+}
+
+/* Append blocks first..first+blocks in mode, joined to the segment before of the same mode */
+static void em_seg_add(unsigned long first, unsigned long blocks, int mode)
+{
+	struct em_seg *s = em.nsegs ? &em.s[em.nsegs - 1] : NULL;
+
+	if (!blocks)
+		return;
+	if (s && s->mode == mode) {
+		s->blocks += blocks;
+		s->lsize += (unsigned long long)blocks * em_unit(mode);
+	} else {
+		s = &em.s[em.nsegs++];
+		s->first = first;
+		s->blocks = blocks;
+		s->mode = mode;
+		s->lstart = em.size;
+		s->lsize = (unsigned long long)blocks * em_unit(mode);
+	}
+	em.size += (unsigned long long)blocks * em_unit(mode);
+}
+
+int eccmap_attach(struct flash_cmd *cmd, char **spec, int nspec, long long *flen)
+{
+	struct em_region *r;
+	unsigned long next = 0, eb;
+	int i, def, raw = 0;
+
+	memset(&em, 0, sizeof(em));
+	snand_ecc_geometry(&em.geo);
+	em.ppb = em.geo.erase_size / em.geo.page_size;
+	em.rpage = em.geo.page_size + em.geo.oob_size;
+	em.def_ecc = ECC_fcheck;
+	def = ECC_fcheck ? EM_ECC : EM_RAW_OOB;
+	eb = em.geo.erase_size;
+
+	r = malloc(nspec * sizeof(*r));
+	em.s = malloc((2 * nspec + 1) * sizeof(*em.s));
+	if (!r || !em.s) {
+		printf("Malloc failed for ECC regions.\n");
+		goto fail;
+	}
+	for (i = 0; i < nspec; i++) {
+		if (em_parse(spec[i], &r[i]) < 0)
+			goto fail;
+		raw |= r[i].mode == EM_RAW;
+	}
+	qsort(r, nspec, sizeof(*r), em_region_cmp);
+	for (i = 0; i < nspec; i++) {
+		if (r[i].addr / eb < next) {
+			printf("ECC regions overlap at 0x%08llX\n", r[i].addr);
+			goto fail;
+		}
+		em_seg_add(next, r[i].addr / eb - next, def);
+		em_seg_add(r[i].addr / eb, r[i].len / eb, r[i].mode);
+		next = (r[i].addr + r[i].len) / eb;
+	}
+	em_seg_add(next, em.geo.size / eb - next, def);
+	if (raw && !(em.scratch = malloc(em.ppb * em.rpage))) {
+		printf("Malloc failed for ECC regions.\n");
+		goto fail;
+	}
+	free(r);
+
+	printf("ECC regions: chip 0x%08llX, %lu byte pages + %lu OOB\n", em.geo.size, em.geo.page_size, em.geo.oob_size);
+	printf("Chip                       Mode     Image\n");
+	for (i = 0; i < em.nsegs; i++)
+		printf("0x%08llX - 0x%08llX  %-8s 0x%08llX - 0x%08llX\n",
+			(unsigned long long)em.s[i].first * eb, (unsigned long long)(em.s[i].first + em.s[i].blocks) * eb - 1,
+			em_names[em.s[i].mode], em.s[i].lstart, em.s[i].lstart + em.s[i].lsize - 1);
+
+	em.cmd = cmd;
+	em.orig = *cmd;
+	cmd->flash_read = em_read;
+	cmd->flash_write = em_write;
+	cmd->flash_erase = em_erase;
+	*flen = em.size;
+	return 0;
+fail:
+	free(r);
+	free(em.s);
+	memset(&em, 0, sizeof(em));
+	return -1;
+}
+
+void eccmap_detach(void)
+{
+	if (!em.cmd)
+		return;
+	em.cmd->flash_read = em.orig.flash_read;
+	em.cmd->flash_write = em.orig.flash_write;
+	em.cmd->flash_erase = em.orig.flash_erase;
+	snand_ecc_mode(em.def_ecc);
+	printf("ECC regions: %lu ECC mode switches\n", em.switches);
+	free(em.s);
+	free(em.scratch);
+	memset(&em, 0, sizeof(em));
+}
+/* End of [eccmap.c] package */
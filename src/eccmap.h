@@ -0,0 +1,32 @@
+/*
+ * eccmap.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __ECCMAP_H__
+#define __ECCMAP_H__
+
+#include "flashcmd_api.h"
+
+/*
+ * Route the callbacks of cmd through the ECC region table, one region
+ * <addr>:<len>:<ecc|raw|raw+oob> per spec, chip addresses without the OOB.
+ * The rest of the chip is ecc, raw+oob with -d. The image is the regions
+ * one after another in chip order, *flen is set to its size.
+ * Returns 0 or -1.
+ */
+int eccmap_attach(struct flash_cmd *cmd, char **spec, int nspec, long long *flen);
+
+/* Restore the callbacks of cmd and the ECC mode of the session */
+void eccmap_detach(void);
+
+#endif /* __ECCMAP_H__ */
+/* End of [eccmap.h] package */
@@ -0,0 +1,269 @@
+/*
+ * flash_stat.c
+ *
+ * Busy time characterization for page program and block erase.
+ * The busy time is estimated from the number of status polls and the
+ * cost of one poll, which is calibrated on the device before the job.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash_stat.h"
+#include "profile.h"
+#include "timer.h"
+
+#define STAT_CALIBRATE_POLLS	16
+#define STAT_MAP_COLUMNS	64
+#define STAT_WORN_FACTOR	2	/* flag blocks slower than 2x median */
+#define STAT_MAX_WORN_PRINT	32
+
+int stat_enable = 0;
+
+static char stat_chip[64];
+static unsigned long stat_nblocks;
+static unsigned long stat_poll_us;
+static struct busy_timing *stat_wait;
+
+static unsigned long *stat_erase;	/* per block erase time, 0 - not measured */
+static unsigned long long *stat_prog_sum;
+static unsigned long *stat_prog_cnt;
+
+static unsigned long *stat_samples[2];
+static unsigned long stat_count[2], stat_size[2];
+
+static const char *stat_op_name[2] = { "Program", "Erase" };
+static const char stat_shade[] = ".:-=+*#%@";
+
+void stat_load_timing(const char *chip, const struct chip_timing *typ, struct busy_timing *wait)
+{
+	unsigned long v;
+
+	/* Without measurements start polling at half the datasheet typical time */
+	if (typ) {
+		wait->prog_us = typ->prog_typ / 2;
+		wait->erase_us = typ->erase_typ / 2;
+	}
+	if (!profile_get(chip, "prog_us", &v))
+		wait->prog_us = v;
+	if (!profile_get(chip, "erase_us", &v)) {
+		wait->erase_us = v;
+		printf("Measured wait timing: program %lu us, erase %lu us\n", wait->prog_us, wait->erase_us);
+	}
+}
+
+void stat_begin(const char *chip, unsigned long nblocks, int (*poll)(void), struct busy_timing *wait)
+{
+	unsigned long long t;
+	int i;
+
+	if (!stat_enable)
+		return;
+
+	strncpy(stat_chip, chip, sizeof(stat_chip) - 1);
+	stat_nblocks = nblocks;
+	stat_wait = wait;
+
+	stat_erase = calloc(nblocks, sizeof(*stat_erase));
+	stat_prog_sum = calloc(nblocks, sizeof(*stat_prog_sum));
+	stat_prog_cnt = calloc(nblocks, sizeof(*stat_prog_cnt));
+	if (!stat_erase || !stat_prog_sum || !stat_prog_cnt) {
+		printf("Malloc failed for busy time statistics.\n");
+		stat_enable = 0;
+		return;
+	}
+
+	/* Calibrate the cost of one status poll while the chip is idle */
+	t = timer_usec();
+	for (i = 0; i < STAT_CALIBRATE_POLLS; i++)
+		poll();
+	stat_poll_us = (timer_usec() - t) / STAT_CALIBRATE_POLLS;
+	if (!stat_poll_us)
+		stat_poll_us = 1;
+
+	printf("Busy time characterization: %lu blocks, status poll %lu us\n", nblocks, stat_poll_us);
+}
+
+void stat_record(int op, unsigned long block, unsigned long polls)
+{
+	unsigned long busy, *p;
+
+	if (!stat_enable || !stat_nblocks || block >= stat_nblocks)
+		return;
+
+	busy = polls * stat_poll_us;
+	if (stat_wait)
+		busy += (op == STAT_OP_ERASE) ? stat_wait->erase_us : stat_wait->prog_us;
+	if (!busy)
+		busy = 1;
+
+	if (stat_count[op] == stat_size[op]) {
+		stat_size[op] = stat_size[op] ? stat_size[op] * 2 : 4096;
+		p = realloc(stat_samples[op], stat_size[op] * sizeof(*p));
+		if (!p) {
+			stat_size[op] = stat_count[op];
+			return;
+		}
+		stat_samples[op] = p;
+	}
+	stat_samples[op][stat_count[op]++] = busy;
+
+	if (op == STAT_OP_ERASE) {
+		stat_erase[block] = busy;
+	} else {
+		stat_prog_sum[block] += busy;
+		stat_prog_cnt[block]++;
+	}
+}
+
+static int stat_cmp(const void *a, const void *b)
+{
+	unsigned long x = *(const unsigned long *)a, y = *(const unsigned long *)b;
+
+	return (x > y) - (x < y);
+}
+
+static double stat_sqrt(double v)
+{
+	double r = v;
+	int i;
+
+	if (v <= 0)
+		return 0;
+	for (i = 0; i < 32; i++)
+		r = (r + v / r) / 2;
+	return r;
+}
+
+static unsigned long stat_pct(unsigned long *sorted, unsigned long n, int pct)
+{
+	return sorted[(n - 1) * pct / 100];
+}
+
+/* Print distribution and return the 10th percentile, 0 if no samples */
+static unsigned long stat_distribution(int op)
+{
+	unsigned long n = stat_count[op], i, *s = stat_samples[op];
+	double sum = 0, sq = 0, avg;
+
+	if (!n)
+		return 0;
+
+	qsort(s, n, sizeof(*s), stat_cmp);
+	for (i = 0; i < n; i++) {
+		sum += s[i];
+		sq += (double)s[i] * s[i];
+	}
+	avg = sum / n;
+
+	printf("%-8s %lu samples, min %lu, avg %.0f, p50 %lu, p90 %lu, p99 %lu, max %lu, stddev %.0f (us)\n",
+		stat_op_name[op], n, s[0], avg, stat_pct(s, n, 50), stat_pct(s, n, 90),
+		stat_pct(s, n, 99), s[n - 1], stat_sqrt(sq / n - avg * avg));
+
+	return stat_pct(s, n, 10);
+}
+
+/* Per block heat map with slow (worn) block flagging */
+static void stat_heat_map(int op, unsigned long *val)
+{
+	unsigned long b, n = 0, lo = ~0UL, hi = 0, med, worn = 0, *s;
+
+	for (b = 0; b < stat_nblocks; b++) {
+		if (!val[b])
+			continue;
+		lo = val[b] < lo ? val[b] : lo;
+		hi = val[b] > hi ? val[b] : hi;
+		n++;
+	}
+	if (!n)
+		return;
+
+	if (!(s = malloc(n * sizeof(*s))))
+		return;
+	for (b = 0, n = 0; b < stat_nblocks; b++)
+		if (val[b])
+			s[n++] = val[b];
+	qsort(s, n, sizeof(*s), stat_cmp);
+	med = stat_pct(s, n, 50);
+	free(s);
+
+	printf("\n%s time per block, %lu..%lu us (' ' not measured, '%c' fastest .. '%c' slowest):\n",
+		stat_op_name[op], lo, hi, stat_shade[0], stat_shade[sizeof(stat_shade) - 2]);
+	for (b = 0; b < stat_nblocks; b++) {
+		if (!(b % STAT_MAP_COLUMNS))
+			printf("%6lu ", b);
+		if (!val[b])
+			putchar(' ');
+		else if (hi == lo)
+			putchar(stat_shade[0]);
+		else
+			putchar(stat_shade[(val[b] - lo) * (sizeof(stat_shade) - 2) / (hi - lo)]);
+		if ((b % STAT_MAP_COLUMNS) == STAT_MAP_COLUMNS - 1 || b == stat_nblocks - 1)
+			putchar('\n');
+	}
+
+	for (b = 0; b < stat_nblocks; b++) {
+		if (!val[b] || val[b] <= STAT_WORN_FACTOR * med)
+			continue;
+		if (!worn)
+			printf("Slow blocks (more than %dx median %lu us), possible wear:\n", STAT_WORN_FACTOR, med);
+		if (worn++ < STAT_MAX_WORN_PRINT)
+			printf("  block %lu: %lu us\n", b, val[b]);
+	}
+	if (worn > STAT_MAX_WORN_PRINT)
+		printf("  ... %lu more\n", worn - STAT_MAX_WORN_PRINT);
+}
+
+void stat_report(void)
+{
+	unsigned long b, p10[2], *prog_avg;
+	int op;
+
+	if (!stat_enable || !stat_nblocks)
+		return;
+
+	printf("\nBUSY TIME:\n");
+	if (!stat_count[STAT_OP_PROGRAM] && !stat_count[STAT_OP_ERASE]) {
+		printf("No program or erase operations measured.\n");
+		return;
+	}
+
+	for (op = STAT_OP_PROGRAM; op <= STAT_OP_ERASE; op++)
+		p10[op] = stat_distribution(op);
+
+	if ((prog_avg = calloc(stat_nblocks, sizeof(*prog_avg))) != NULL) {
+		for (b = 0; b < stat_nblocks; b++)
+			if (stat_prog_cnt[b])
+				prog_avg[b] = stat_prog_sum[b] / stat_prog_cnt[b];
+		stat_heat_map(STAT_OP_PROGRAM, prog_avg);
+		free(prog_avg);
+	}
+	stat_heat_map(STAT_OP_ERASE, stat_erase);
+
+	/*
+	 * Feed back into the wait engine: sleep ~90% of the fast tail before
+	 * the first busy poll, so most operations finish with one poll.
+	 */
+	if (p10[STAT_OP_PROGRAM]) {
+		stat_wait->prog_us = p10[STAT_OP_PROGRAM] * 9 / 10;
+		profile_set(stat_chip, "prog_us", stat_wait->prog_us);
+	}
+	if (p10[STAT_OP_ERASE]) {
+		stat_wait->erase_us = p10[STAT_OP_ERASE] * 9 / 10;
+		profile_set(stat_chip, "erase_us", stat_wait->erase_us);
+	}
+	printf("\nSaved wait timing for %s: program %lu us, erase %lu us\n",
+		stat_chip, stat_wait->prog_us, stat_wait->erase_us);
+}
+/* End of [flash_stat.c] package */
@@ -0,0 +1,41 @@
+/*
+ * flash_stat.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __FLASH_STAT_H__
+#define __FLASH_STAT_H__
+
+#define STAT_OP_PROGRAM		0
+#define STAT_OP_ERASE		1
+
+/* Datasheet timings in usec, 0 - not applicable */
+struct chip_timing {
+	unsigned long read_typ, read_max;	/* tR: NAND page read to cache */
+	unsigned long prog_typ, prog_max;	/* tPROG / tPP / tWR */
+	unsigned long erase_typ, erase_max;	/* tBERS / tSE */
+};
+
+/* Wait engine parameters: delay before the first busy poll, in usec */
+struct busy_timing {
+	unsigned long prog_us;
+	unsigned long erase_us;
+};
+
+extern int stat_enable;
+
+void stat_load_timing(const char *chip, const struct chip_timing *typ, struct busy_timing *wait);
+void stat_begin(const char *chip, unsigned long nblocks, int (*poll)(void), struct busy_timing *wait);
+void stat_record(int op, unsigned long block, unsigned long polls);
+void stat_report(void);
+
+#endif /* __FLASH_STAT_H__ */
+/* End of [flash_stat.h] package */
@@ -15,6 +15,7 @@
 
 #include <stdio.h>
 #include "flashcmd_api.h"
+#include "spi_speed.h"
 
 #ifdef EEPROM_SUPPORT
 #define __EEPROM___	"or EEPROM"
@@ -24,32 +25,39 @@ extern int mw_eepromsize;
 #define __EEPROM___	""
 #endif
 
-long flash_cmd_init(struct flash_cmd *cmd)
+long long flash_cmd_init(struct flash_cmd *cmd)
 {
-	long flen = -1;
+	long long flen = -1;
 
 #ifdef EEPROM_SUPPORT
 	if ((eepromsize <= 0) && (mw_eepromsize <= 0)) {
 #endif
+		spi_speed_probe();
 		if ((flen = snand_init()) > 0) {
 			cmd->flash_erase = snand_erase;
 			cmd->flash_write = snand_write;
 			cmd->flash_read  = snand_read;
+			cmd->flash_info  = snand_info;
 		} else if ((flen = snor_init()) > 0) {
 			cmd->flash_erase = snor_erase;
 			cmd->flash_write = snor_write;
 			cmd->flash_read  = snor_read;
+			cmd->flash_info  = snor_info;
 		}
+		if (flen > 0)
+			spi_speed_chip(cmd);
 #ifdef EEPROM_SUPPORT
 	} else if ((eepromsize > 0) || (mw_eepromsize > 0)) {
 		if ((eepromsize > 0) && (flen = i2c_init()) > 0) {
 			cmd->flash_erase = i2c_eeprom_erase;
 			cmd->flash_write = i2c_eeprom_write;
 			cmd->flash_read  = i2c_eeprom_read;
+			cmd->flash_info  = i2c_eeprom_info;
 		} else if ((mw_eepromsize > 0) && (flen = mw_init()) > 0) {
 			cmd->flash_erase = mw_eeprom_erase;
 			cmd->flash_write = mw_eeprom_write;
 			cmd->flash_read  = mw_eeprom_read;
+			cmd->flash_info  = mw_eeprom_info;
 		}
 	}
 #endif
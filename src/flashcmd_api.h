@@ -22,13 +22,33 @@
 #include "mw_eeprom_api.h"
 #endif
 
+#include "flash_stat.h"
+
+/* Geometry, opcodes and timings of the detected chip for the planner */
+struct flash_info {
+	const char *name;
+	unsigned long page_size;	/* program unit */
+	unsigned long erase_size;	/* erase unit, 0 - no erase command */
+	int skip_blank;			/* all 0xFF program units are not programmed */
+	int read_before_prog;		/* program unit is read back and merged first */
+	int whole_chip;			/* read always transfers the whole chip */
+	int whole_write;		/* write always rewrites the whole chip */
+	int reprogram;			/* programmed bytes can be programmed again, 1 bits to 0 */
+	const char *read_op;
+	const char *prog_op;
+	const char *erase_op;
+	const struct chip_timing *timing;
+	unsigned long link_rate;	/* bytes/sec, 0 - measure the SPI link */
+};
+
 struct flash_cmd {
-	int (*flash_read)(unsigned char *buf, unsigned long from, unsigned long len);
-	int (*flash_erase)(unsigned long offs, unsigned long len);
-	int (*flash_write)(unsigned char *buf, unsigned long to, unsigned long len);
+	long long (*flash_read)(unsigned char *buf, unsigned long long from, unsigned long long len);
+	int (*flash_erase)(unsigned long long offs, unsigned long long len);
+	long long (*flash_write)(unsigned char *buf, unsigned long long to, unsigned long long len);
+	void (*flash_info)(struct flash_info *info);
 };
 
-long flash_cmd_init(struct flash_cmd *cmd);
+long long flash_cmd_init(struct flash_cmd *cmd);
 void support_flash_list(void);
 
 #endif /* __FLASHCMD_API_H__ */
@@ -0,0 +1,335 @@
+/*
+ * fwid.c
+ *
+ * Known firmware identification. The index keeps a 64-bit FNV-1a hash of
+ * every unit of each release image. Identification reads the unit that
+ * splits the remaining candidates best, drops the candidates that do not
+ * match and repeats, so a handful of reads replaces a full dump.
+ *
+ * Index file format (text):
+ *   unit <bytes>
+ *   image <size> <version>
+ *   <hash of unit 0>
+ *   ...
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "fwid.h"
+
+#define FWID_UNIT	65536	/* largest common NOR erase block */
+#define FWID_NAME	128
+#define FWID_LINE	256
+#define FWID_MAX_MISS	2	/* units matching no candidate (device data) */
+#define FWID_CONFIRM	2	/* extra units read for a single candidate */
+
+struct fwid_image {
+	char name[FWID_NAME];
+	unsigned long long size;
+	unsigned long units;
+	uint64_t *hash;
+};
+
+struct fwid_index {
+	unsigned long unit;
+	int count;
+	struct fwid_image *img;
+};
+
+static uint64_t fwid_hash(const unsigned char *p, unsigned long len)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	while (len--) {
+		h ^= *p++;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static void fwid_free(struct fwid_index *idx)
+{
+	int i;
+
+	for (i = 0; i < idx->count; i++)
+		free(idx->img[i].hash);
+	free(idx->img);
+	idx->img = NULL;
+	idx->count = 0;
+}
+
+static struct fwid_image *fwid_new_image(struct fwid_index *idx)
+{
+	struct fwid_image *p = realloc(idx->img, (idx->count + 1) * sizeof(*p));
+
+	if (!p)
+		return NULL;
+	idx->img = p;
+	p = &idx->img[idx->count++];
+	memset(p, 0, sizeof(*p));
+	return p;
+}
+
+/* A missing index file is an empty index */
+static int fwid_load(const char *path, struct fwid_index *idx)
+{
+	char line[FWID_LINE];
+	struct fwid_image *img = NULL;
+	unsigned long n = 0;
+	unsigned long long v;
+	FILE *fp;
+
+	memset(idx, 0, sizeof(*idx));
+	idx->unit = FWID_UNIT;
+	if (!(fp = fopen(path, "r")))
+		return 0;
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "unit %lu", &idx->unit) == 1)
+			continue;
+		if (!strncmp(line, "image ", 6)) {
+			if (!(img = fwid_new_image(idx)) ||
+			    sscanf(line, "image %llu %127[^\r\n]", &img->size, img->name) != 2)
+				goto err;
+			img->units = (img->size + idx->unit - 1) / idx->unit;
+			if (!(img->hash = calloc(img->units, sizeof(*img->hash))))
+				goto err;
+			n = 0;
+			continue;
+		}
+		if (img && n < img->units && sscanf(line, "%llx", &v) == 1)
+			img->hash[n++] = v;
+	}
+	fclose(fp);
+	return 0;
+err:
+	printf("Error parsing firmware index %s\n", path);
+	fclose(fp);
+	fwid_free(idx);
+	return -1;
+}
+
+static int fwid_save(const char *path, struct fwid_index *idx)
+{
+	unsigned long u;
+	FILE *fp;
+	int i;
+
+	if (!(fp = fopen(path, "w"))) {
+		printf("Couldn't open file %s for writing.\n", path);
+		return -1;
+	}
+	fprintf(fp, "unit %lu\n", idx->unit);
+	for (i = 0; i < idx->count; i++) {
+		fprintf(fp, "image %llu %s\n", idx->img[i].size, idx->img[i].name);
+		for (u = 0; u < idx->img[i].units; u++)
+			fprintf(fp, "%016llx\n", (unsigned long long)idx->img[i].hash[u]);
+	}
+	fclose(fp);
+	return 0;
+}
+
+int fwid_add(const char *index, const char *image, const char *version)
+{
+	struct fwid_index idx;
+	struct fwid_image *img = NULL;
+	unsigned char *buf;
+	unsigned long u;
+	size_t n;
+	FILE *fp;
+	int i;
+
+	if (fwid_load(index, &idx) < 0)
+		return -1;
+	if (!(fp = fopen(image, "rb"))) {
+		printf("Couldn't open file %s for reading.\n", image);
+		fwid_free(&idx);
+		return -1;
+	}
+	if (!(buf = malloc(idx.unit))) {
+		printf("Malloc failed for firmware index.\n");
+		goto err;
+	}
+
+	/* Same version again replaces the old entry */
+	for (i = 0; i < idx.count; i++) {
+		if (!strcmp(idx.img[i].name, version)) {
+			img = &idx.img[i];
+			free(img->hash);
+			img->hash = NULL;
+			img->size = 0;
+		}
+	}
+	if (!img && !(img = fwid_new_image(&idx)))
+		goto err;
+	strncpy(img->name, version, FWID_NAME - 1);
+
+	for (u = 0; (n = fread(buf, 1, idx.unit, fp)) > 0; u++) {
+		uint64_t *p = realloc(img->hash, (u + 1) * sizeof(*p));
+		if (!p)
+			goto err;
+		img->hash = p;
+		img->hash[u] = fwid_hash(buf, n);
+		img->size += n;
+	}
+	img->units = u;
+	fclose(fp);
+	free(buf);
+
+	printf("Added %s: %llu bytes, %lu units of %lu bytes, %d images in %s\n",
+		img->name, img->size, img->units, idx.unit, idx.count, index);
+	i = fwid_save(index, &idx);
+	fwid_free(&idx);
+	return i;
+err:
+	fclose(fp);
+	free(buf);
+	fwid_free(&idx);
+	return -1;
+}
+
+/* Number of candidate pairs unit u separates */
+static unsigned long fwid_split(struct fwid_index *idx, int *cand, int ncand, unsigned long u)
+{
+	unsigned long same = 0;
+	int i, j;
+
+	for (i = 0; i < ncand; i++)
+		for (j = i + 1; j < ncand; j++)
+			if (idx->img[cand[i]].hash[u] == idx->img[cand[j]].hash[u])
+				same++;
+	return (unsigned long)ncand * (ncand - 1) / 2 - same;
+}
+
+/* Number of other images unit u of image c differs from */
+static unsigned long fwid_distinct(struct fwid_index *idx, int c, unsigned long u)
+{
+	unsigned long n = 0;
+	int i;
+
+	for (i = 0; i < idx->count; i++)
+		if (i != c && (u >= idx->img[i].units || idx->img[i].hash[u] != idx->img[c].hash[u]))
+			n++;
+	return n;
+}
+
+int fwid_identify(struct flash_cmd *cmd, long long flen, const char *index)
+{
+	struct fwid_index idx;
+	struct fwid_image *img;
+	unsigned long u, best, score, units = ~0UL, nread = 0, miss = 0, confirm = 0;
+	unsigned char *buf = NULL, *done = NULL;
+	unsigned long long off, len;
+	int *cand = NULL, ncand = 0, i, n, ret = -1;
+	uint64_t h;
+
+	if (fwid_load(index, &idx) < 0)
+		return -1;
+	if (!idx.count) {
+		printf("Firmware index %s is empty.\n", index);
+		return -1;
+	}
+
+	cand = malloc(idx.count * sizeof(*cand));
+	for (i = 0; cand && i < idx.count; i++) {
+		if (idx.img[i].size > flen)
+			continue;
+		cand[ncand++] = i;
+		if (idx.img[i].units < units)
+			units = idx.img[i].units;
+	}
+	if (!ncand) {
+		printf("No image in %s fits a chip of %lld bytes.\n", index, flen);
+		goto out;
+	}
+	buf = malloc(idx.unit);
+	done = calloc(units, 1);
+	if (!cand || !buf || !done) {
+		printf("Malloc failed for firmware identification.\n");
+		goto out;
+	}
+
+	printf("IDENTIFY: %d candidates, %lu units of %lu bytes\n", ncand, units, idx.unit);
+	while (1) {
+		/* Pick the unread unit that separates most candidate pairs */
+		best = units;
+		score = 0;
+		for (u = 0; u < units; u++) {
+			if (done[u])
+				continue;
+			n = ncand > 1 ? fwid_split(&idx, cand, ncand, u) : fwid_distinct(&idx, cand[0], u);
+			if (best == units || n > score) {
+				best = u;
+				score = n;
+			}
+		}
+		if (best == units || (ncand > 1 && !score) || (ncand == 1 && confirm >= FWID_CONFIRM))
+			break;
+
+		off = (unsigned long long)best * idx.unit;
+		len = flen - off < idx.unit ? flen - off : idx.unit;
+		if (cmd->flash_read(buf, off, len) < 0) {
+			printf("Read error at 0x%llx\n", off);
+			goto out;
+		}
+		done[best] = 1;
+		nread++;
+
+		/* The last unit of an image is hashed up to the image end */
+		for (i = 0, n = 0; i < ncand; i++) {
+			img = &idx.img[cand[i]];
+			h = fwid_hash(buf, img->size - off < len ? img->size - off : len);
+			if (img->hash[best] == h)
+				cand[n++] = cand[i];
+		}
+		if (!n) {
+			/* Device specific data (config, env) or unknown firmware */
+			printf("Unit %lu (0x%llx) matches none of %d candidates\n", best, off, ncand);
+			if (++miss > FWID_MAX_MISS)
+				break;
+			continue;
+		}
+		if (ncand == 1)
+			confirm++;
+		else
+			printf("Unit %lu (0x%llx): %d of %d candidates left\n", best, off, n, ncand);
+		ncand = n;
+	}
+
+	if (miss > FWID_MAX_MISS) {
+		printf("Unknown firmware, a full dump is needed (%lu units read).\n", nread);
+	} else if (ncand == 1) {
+		printf("Firmware: %s (%lu units, %llu bytes read", idx.img[cand[0]].name,
+			nread, (unsigned long long)nread * idx.unit);
+		if (miss)
+			printf(", %lu units differ", miss);
+		printf(")\n");
+		ret = 0;
+	} else {
+		printf("Firmware not resolved, %d candidates match (%lu units read, %lu differ):\n",
+			ncand, nread, miss);
+		for (i = 0; i < ncand; i++)
+			printf("  %s\n", idx.img[cand[i]].name);
+		ret = 0;
+	}
+out:
+	free(cand);
+	free(buf);
+	free(done);
+	fwid_free(&idx);
+	return ret;
+}
+/* End of [fwid.c] package */
@@ -0,0 +1,26 @@
+/*
+ * fwid.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __FWID_H__
+#define __FWID_H__
+
+#include "flashcmd_api.h"
+
+/* Add (or replace) a release image in the index, no chip needed */
+int fwid_add(const char *index, const char *image, const char *version);
+
+/* Read a few discriminating units of the chip and match them to the index */
+int fwid_identify(struct flash_cmd *cmd, long long flen, const char *index);
+
+#endif /* __FWID_H__ */
+/* End of [fwid.h] package */
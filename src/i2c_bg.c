@@ -0,0 +1,193 @@
+/*
+ * i2c_bg.c
+ *
+ * I2C EEPROM write in the background of a SPI session. The 24Cxx sits on
+ * the CH341A I2C pins, apart from the SPI ones, so its pages can go out
+ * between SPI transactions. A page is sent only once the tWR of the one
+ * before has passed on the host clock, there is no in-stream delay to
+ * stall the SPI traffic behind it. The pages the SPI job left are written
+ * after it with host side waits.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ch341a_spi.h"
+#include "ch341a_i2c.h"
+#include "spi_speed.h"
+#include "sim.h"
+#include "timer.h"
+#include "i2c_bg.h"
+
+#define I2C_BG_BYTE_NS	90000ULL	/* 8 bits + ACK at 100kHz */
+
+static struct {
+	struct EEPROM info;
+	char name[12];
+	uint8_t *data;
+	uint32_t len, pos;
+	unsigned long long twr;		/* nsec */
+	unsigned long long due;		/* nsec, the next page may be addressed */
+	unsigned long pages;
+	int active, error;
+} bg;
+
+static unsigned long long i2c_bg_now(void)
+{
+	return sim_enable ? sim_now : timer_usec() * 1000ULL;
+}
+
+static void i2c_bg_wait(void)
+{
+	unsigned long long now = i2c_bg_now();
+
+	if (now >= bg.due)
+		return;
+	if (sim_enable)
+		sim_sleep(bg.due - now);
+	else
+		usleep((bg.due - now) / 1000 + 1);
+}
+
+/* One page at the EEPROM bus speed, then the SPI setting is back */
+static int i2c_bg_page(void)
+{
+	uint8_t out[EEPROM_WRITE_BUF_SZ + 2 * mCH341_PACKET_LENGTH], *p = out;
+	uint16_t chunk = MIN(bg.len - bg.pos, bg.info.page_size - bg.pos % bg.info.page_size);
+
+	memset(p, 0, mCH341_PACKET_LENGTH);
+	p[0] = mCH341A_CMD_I2C_STREAM;
+	p[1] = mCH341A_CMD_I2C_STM_SET | CH341_I2C_STANDARD_SPEED;
+	p[2] = mCH341A_CMD_I2C_STM_END;
+	p += mCH341_PACKET_LENGTH;
+	p += ch341pageEEPROM(p, bg.data + bg.pos, bg.pos, chunk, &bg.info);
+	*p++ = mCH341A_CMD_I2C_STREAM;
+	*p++ = mCH341A_CMD_I2C_STM_SET | spi_speed;
+	*p++ = mCH341A_CMD_I2C_STM_END;
+
+	if (ch341sendEEPROM(out, p - out) < 0) {
+		bg.error = 1;
+		return -1;
+	}
+	bg.pos += chunk;
+	bg.pages++;
+	/* The simulator has run the bus already, the CH341A has only queued it */
+	bg.due = i2c_bg_now() + bg.twr + (sim_enable ? 0 : (chunk + 3) * I2C_BG_BYTE_NS);
+	return 0;
+}
+
+static void i2c_bg_idle(void)
+{
+	if (!bg.error && bg.pos < bg.len && i2c_bg_now() >= bg.due)
+		i2c_bg_page();
+}
+
+int i2c_bg_start(const char *spec)
+{
+	const char *file = strchr(spec, ':');
+	FILE *fp;
+	long n;
+
+	memset(&bg, 0, sizeof(bg));
+	if (!file || file == spec || file - spec >= sizeof(bg.name)) {
+		printf("I2C write %s is not <24cxx>:<file>\n", spec);
+		return -1;
+	}
+	memcpy(bg.name, spec, file - spec);
+	if (parseEEPsize(bg.name, &bg.info) <= 0) {
+		printf("Unknown EEPROM chip %s!!!\n", bg.name);
+		return -1;
+	}
+
+	if (!(fp = fopen(++file, "rb"))) {
+		printf("Couldn't open file %s for reading.\n", file);
+		return -1;
+	}
+	fseek(fp, 0, SEEK_END);
+	n = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (n <= 0 || n > bg.info.size) {
+		printf("File %s is empty or larger than %s\n", file, bg.name);
+		fclose(fp);
+		return -1;
+	}
+	bg.len = n;
+	if (!(bg.data = malloc(bg.len)) || fread(bg.data, 1, bg.len, fp) != bg.len) {
+		printf("Couldn't read file %s.\n", file);
+		fclose(fp);
+		free(bg.data);
+		return -1;
+	}
+	fclose(fp);
+
+	if (sim_enable) {
+		sim_24cxx_select(&bg.info);
+		if (sim_attach_i2c(&sim_24cxx) < 0) {
+			free(bg.data);
+			return -1;
+		}
+	}
+
+	bg.twr = ch341twrEEPROM(&bg.info) * 1000000ULL;
+	bg.active = 1;
+	ch341a_spi_idle = i2c_bg_idle;
+	printf("I2C write: %s, %u bytes from %s between the SPI transactions, tWR %llu ms\n",
+		bg.name, bg.len, file, bg.twr / 1000000);
+	return 0;
+}
+
+int i2c_bg_finish(int verify)
+{
+	unsigned long during = bg.pages;
+	unsigned long long start = i2c_bg_now();
+	uint8_t *rbuf;
+	int ret = 0;
+
+	if (!bg.active)
+		return 0;
+	ch341a_spi_idle = NULL;
+
+	while (!bg.error && bg.pos < bg.len) {
+		i2c_bg_wait();
+		i2c_bg_page();
+	}
+	i2c_bg_wait();
+	printf("I2C write: %lu pages of %u bytes, %lu between the SPI transactions, %lu after, %llu ms after the SPI job\n",
+		bg.pages, bg.info.page_size, during, bg.pages - during, (i2c_bg_now() - start) / 1000000);
+	if (bg.error)
+		ret = -1;
+
+	if (!ret && verify) {
+		if (!(rbuf = malloc(bg.info.size))) {
+			printf("Malloc failed for read buffer.\n");
+			ret = -1;
+		} else {
+			timer_mute(1);
+			ret = config_stream(CH341_I2C_STANDARD_SPEED) < 0 ||
+			      ch341readEEPROM(rbuf, bg.info.size, &bg.info) < 0 ? -1 : 0;
+			config_stream(spi_speed);
+			timer_mute(0);
+			if (!ret && memcmp(rbuf, bg.data, bg.len))
+				ret = 1;
+			printf("I2C verify: %s\n", ret ? "failed" : "OK");
+			free(rbuf);
+		}
+	}
+
+	free(bg.data);
+	bg.active = 0;
+	return ret;
+}
+/* End of [i2c_bg.c] package */
@@ -0,0 +1,30 @@
+/*
+ * i2c_bg.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __I2C_BG_H__
+#define __I2C_BG_H__
+
+/*
+ * Start writing <24cxx>:<file> to the I2C EEPROM between the SPI
+ * transactions of the session. Returns 0 or -1.
+ */
+int i2c_bg_start(const char *spec);
+
+/*
+ * Write what the SPI job left, wait out the last tWR and read back with
+ * verify. Returns 0 OK, 1 verify failed, -1 error.
+ */
+int i2c_bg_finish(int verify);
+
+#endif /* __I2C_BG_H__ */
+/* End of [i2c_bg.h] package */
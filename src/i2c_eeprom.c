@@ -16,13 +16,14 @@
 #include "ch341a_spi.h"
 #include "ch341a_i2c.h"
 #include "timer.h"
+#include "flashcmd_api.h"
 
 extern unsigned int bsize;
 struct EEPROM eeprom_info;
 char eepromname[12];
 int eepromsize = 0;
 
-int i2c_eeprom_read(unsigned char *buf, unsigned long from, unsigned long len)
+long long i2c_eeprom_read(unsigned char *buf, unsigned long long from, unsigned long long len)
 {
 	unsigned char *pbuf, ebuf[MAX_EEPROM_SIZE];
 
@@ -34,79 +35,60 @@ int i2c_eeprom_read(unsigned char *buf, unsigned long from, unsigned long len)
 	pbuf = ebuf;
 
 	if (ch341readEEPROM(pbuf, eepromsize, &eeprom_info) < 0) {
-		printf("Couldnt read [%d] bytes from [%s] EEPROM address 0x%08lu\n", (int)len, eepromname, from);
+		printf("Couldnt read [%d] bytes from [%s] EEPROM address 0x%08llX\n", (int)len, eepromname, from);
 		return -1;
 	}
 
 	memcpy(buf, pbuf + from, len);
 
-	printf("Read [%d] bytes from [%s] EEPROM address 0x%08lu\n", (int)len, eepromname, from);
+	printf("Read [%d] bytes from [%s] EEPROM address 0x%08llX\n", (int)len, eepromname, from);
 	timer_end();
 
-	return (int)len;
+	return len;
 }
 
-int i2c_eeprom_erase(unsigned long offs, unsigned long len)
+int i2c_eeprom_erase(unsigned long long offs, unsigned long long len)
 {
-	unsigned char *pbuf, ebuf[MAX_EEPROM_SIZE];
+	unsigned char ebuf[MAX_EEPROM_SIZE];
 
 	if (len == 0)
 		return -1;
 
 	timer_start();
 	memset(ebuf, 0xff, sizeof(ebuf));
-	pbuf = ebuf;
-
-	if (offs || len < eepromsize) {
-		if (ch341readEEPROM(pbuf, eepromsize, &eeprom_info) < 0) {
-			printf("Couldnt read [%d] bytes from [%s] EEPROM\n", eepromsize, eepromname);
-			return -1;
-		}
-		memset(pbuf + offs, 0xff, len);
-	}
 
-	if(ch341writeEEPROM(pbuf, eepromsize, &eeprom_info) < 0) {
-		printf("Failed to erase [%d] bytes of [%s] EEPROM address 0x%08lu\n", (int)len, eepromname, offs);
+	/* Only the pages of the range are written */
+	if(ch341writeEEPROM(ebuf, offs, len, &eeprom_info) < 0) {
+		printf("Failed to erase [%d] bytes of [%s] EEPROM address 0x%08llX\n", (int)len, eepromname, offs);
 		return -1;
 	}
 
-	printf("Erased [%d] bytes of [%s] EEPROM address 0x%08lu\n", (int)len, eepromname, offs);
+	printf("Erased [%d] bytes of [%s] EEPROM address 0x%08llX\n", (int)len, eepromname, offs);
 	timer_end();
 
 	return 0;
 }
 
-int i2c_eeprom_write(unsigned char *buf, unsigned long to, unsigned long len)
+long long i2c_eeprom_write(unsigned char *buf, unsigned long long to, unsigned long long len)
 {
-	unsigned char *pbuf, ebuf[MAX_EEPROM_SIZE];
-
 	if (len == 0)
 		return -1;
 
 	timer_start();
-	memset(ebuf, 0xff, sizeof(ebuf));
-	pbuf = ebuf;
-
-	if (to || len < eepromsize) {
-		if (ch341readEEPROM(pbuf, eepromsize, &eeprom_info) < 0) {
-			printf("Couldnt read [%d] bytes from [%s] EEPROM\n", (int)len, eepromname);
-			return -1;
-		}
-	}
-	memcpy(pbuf + to, buf, len);
 
-	if(ch341writeEEPROM(pbuf, eepromsize, &eeprom_info) < 0) {
-		printf("Failed to write [%d] bytes of [%s] EEPROM address 0x%08lu\n", (int)len, eepromname, to);
+	/* Page writes only change the bytes sent, no read-modify-write */
+	if(ch341writeEEPROM(buf, to, len, &eeprom_info) < 0) {
+		printf("Failed to write [%d] bytes of [%s] EEPROM address 0x%08llX\n", (int)len, eepromname, to);
 		return -1;
 	}
 
-	printf("Wrote [%d] bytes to [%s] EEPROM address 0x%08lu\n", (int)len, eepromname, to);
+	printf("Wrote [%d] bytes to [%s] EEPROM address 0x%08llX\n", (int)len, eepromname, to);
 	timer_end();
 
-	return (int)len;
+	return len;
 }
 
-long i2c_init(void)
+long long i2c_init(void)
 {
 	if (config_stream(CH341_I2C_STANDARD_SPEED) < 0)
 		return -1;
@@ -120,7 +102,25 @@ long i2c_init(void)
 
 	printf("I2C EEPROM chip: %s, Size: %d bytes\n", eepromname, eepromsize);
 
-	return (long)eepromsize;
+	return eepromsize;
+}
+
+void i2c_eeprom_info(struct flash_info *info)
+{
+	static struct chip_timing t;
+
+	/* ch341writeEEPROM() waits tWR max in whole ms in-stream after every page */
+	t.prog_typ = ch341twrEEPROM(&eeprom_info) * 1000;
+	t.prog_max = t.prog_typ;
+
+	memset(info, 0, sizeof(*info));
+	info->name       = eepromname;
+	info->page_size  = eeprom_info.page_size;
+	info->whole_chip = 1;
+	info->read_op    = "I2C stream random read, 128 bytes per command";
+	info->prog_op    = "I2C stream page write";
+	info->timing     = &t;
+	info->link_rate  = CH341_I2C_STANDARD_RATE;
 }
 
 void support_i2c_eeprom_list(void)
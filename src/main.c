@@ -28,6 +28,19 @@
 #include "flashcmd_api.h"
 #include "ch341a_spi.h"
 #include "spi_nand_flash.h"
+#include "flash_stat.h"
+#include "plan.h"
+#include "sim.h"
+#include "serve.h"
+#include "fwid.h"
+#include "spi_speed.h"
+#include "dumpdiff.h"
+#include "blank.h"
+#include "burnin.h"
+#include "wbcache.h"
+#include "badblock.h"
+#include "eccmap.h"
+#include "dumpio.h"
 
 struct flash_cmd prog;
 extern unsigned int bsize;
@@ -35,6 +48,7 @@ extern unsigned int bsize;
 #ifdef EEPROM_SUPPORT
 #include "ch341a_i2c.h"
 #include "bitbang_microwire.h"
+#include "i2c_bg.h"
 extern struct EEPROM eeprom_info;
 extern char eepromname[12];
 extern int eepromsize;
@@ -43,13 +57,75 @@ extern int org;
 #define EHELP	" -E             select I2C EEPROM {24c01|24c02|24c04|24c08|24c16|24c32|24c64|24c128|24c256|24c512|24c1024}\n" \
 		"                select Microwire EEPROM {93c06|93c16|93c46|93c56|93c66|93c76|93c86|93c96} (need SPI-to-MW adapter)\n" \
 		" -8             set organization 8-bit for Microwire EEPROM(default 16-bit) and set jumper on SPI-to-MW adapter\n" \
-		" -f <addr len>  set manual address size in bits for Microwire EEPROM(default auto)\n"
+		" -f <addr len>  set manual address size in bits for Microwire EEPROM(default auto)\n" \
+		" --i2c-write <24cxx>:<file>\n" \
+		"                write an I2C EEPROM on the same board while the SPI flash job runs\n"
 #else
 #define EHELP	""
 #endif
 
 #define _VER	"1.7.5"
 
+/* Long only options */
+#define OPT_PLAN	0x100
+#define OPT_SIM		0x101
+#define OPT_SERVE	0x102
+#define OPT_FW_INDEX	0x103
+#define OPT_FW_ADD	0x104
+#define OPT_FW_ID	0x105
+#define OPT_SPI_SPEED	0x106
+#define OPT_FIXTURE	0x107
+#define OPT_CLEANMARKER	0x108
+#define OPT_MARK_BAD	0x109
+#define OPT_SIM_CHIP	0x10A
+#define OPT_DIFF	0x10B
+#define OPT_CHIP	0x10C
+#define OPT_BEST	0x10D
+#define OPT_BLANK	0x10E
+#define OPT_BLANK_MAP	0x10F
+#define OPT_FILL	0x110
+#define OPT_BURN_IN	0x111
+#define OPT_PATTERN	0x112
+#define OPT_SEED	0x113
+#define OPT_PATCH	0x114
+#define OPT_I2C_WRITE	0x115
+#define OPT_SKIP_BAD	0x116
+#define OPT_BBT		0x117
+#define OPT_ECC_REGION	0x118
+#define OPT_DIRECT	0x119
+
+static struct option long_opts[] = {
+	{ "plan", no_argument, NULL, OPT_PLAN },
+	{ "sim", optional_argument, NULL, OPT_SIM },
+	{ "serve", required_argument, NULL, OPT_SERVE },
+	{ "fw-index", required_argument, NULL, OPT_FW_INDEX },
+	{ "fw-add", required_argument, NULL, OPT_FW_ADD },
+	{ "fw-id", no_argument, NULL, OPT_FW_ID },
+	{ "spi-speed", required_argument, NULL, OPT_SPI_SPEED },
+	{ "fixture", required_argument, NULL, OPT_FIXTURE },
+	{ "cleanmarker", no_argument, NULL, OPT_CLEANMARKER },
+	{ "mark-bad", no_argument, NULL, OPT_MARK_BAD },
+	{ "sim-chip", required_argument, NULL, OPT_SIM_CHIP },
+	{ "diff", required_argument, NULL, OPT_DIFF },
+	{ "chip", required_argument, NULL, OPT_CHIP },
+	{ "best", required_argument, NULL, OPT_BEST },
+	{ "blank", no_argument, NULL, OPT_BLANK },
+	{ "blank-map", no_argument, NULL, OPT_BLANK_MAP },
+	{ "fill", required_argument, NULL, OPT_FILL },
+	{ "burn-in", required_argument, NULL, OPT_BURN_IN },
+	{ "pattern", required_argument, NULL, OPT_PATTERN },
+	{ "seed", required_argument, NULL, OPT_SEED },
+	{ "patch", required_argument, NULL, OPT_PATCH },
+	{ "skip-bad", optional_argument, NULL, OPT_SKIP_BAD },
+	{ "bbt", required_argument, NULL, OPT_BBT },
+	{ "ecc-region", required_argument, NULL, OPT_ECC_REGION },
+	{ "direct", optional_argument, NULL, OPT_DIRECT },
+#ifdef EEPROM_SUPPORT
+	{ "i2c-write", required_argument, NULL, OPT_I2C_WRITE },
+#endif
+	{ NULL, 0, NULL, 0 }
+};
+
 void title(void)
 {
 #ifdef EEPROM_SUPPORT
@@ -74,25 +150,73 @@ void usage(void)
 		" -a <address>   manually set address\n"\
 		" -w <filename>  write chip with data from filename\n"\
 		" -r <filename>  read chip and save data to filename\n"\
-		" -v             verify after write on chip\n";
+		" -v             verify after write on chip\n"\
+		" -T             measure program/erase busy time per block and tune wait timing\n"\
+		" --plan         show the erase/program/read plan and ETA, chip is not changed\n"\
+		" --sim[=<file>] use a simulated programmer and chip, file keeps the chip contents\n"\
+		" --sim-chip <w25n01g|8gbit|16gbit>\n"\
+		"                SPI NAND the simulator models without -E(default: w25n01g)\n"\
+		" --serve <path> serve random access reads of the chip on a Unix socket\n"\
+		" --fw-index <file>\n"\
+		"                firmware index file for --fw-add and --fw-id\n"\
+		" --fw-add <image>[=<version>]\n"\
+		"                add a release image to the firmware index, no chip needed\n"\
+		" --fw-id        identify the firmware on the chip from a few units and the index\n"\
+		" --spi-speed <0-3>\n"\
+		"                force the SPI clock setting, 0 slowest, 3 fastest(default: learned)\n"\
+		" --fixture <name>\n"\
+		"                adapter/clip name, SPI speed is learned per chip and fixture\n"\
+		" --cleanmarker  write JFFS2 cleanmarkers to the OOB of the erased NAND blocks(with -e)\n"\
+		" --mark-bad     mark the NAND block at -a <address> bad in its OOB\n"\
+		" --diff <dump>  compare 2 or more dumps of one NAND(repeat), bitflips per page and block, -d for dumps with OOB\n"\
+		" --chip <name>  SPI NAND from the -L list for the dump geometry, no chip needed\n"\
+		" --best <file>  write the majority voted image of the --diff dumps to file\n"\
+		" --blank        check the chip is erased(full or use with -a [-l]), stop at the first used unit\n"\
+		" --blank-map    check the chip is erased and list all used units, with -d NAND OOB is checked too\n"\
+		" --fill <byte|file>\n"\
+		"                erase and program every good NAND block(full or use with -a [-l]) with a byte or a page pattern file\n"\
+		" --burn-in <cycles>\n"\
+		"                erase/program/verify cycles(full or use with -a [-l]), failures per block\n"\
+		" --pattern <prng|checker|addr>\n"\
+		"                burn-in data(default: prng)\n"\
+		" --seed <n>     burn-in PRNG seed(default: time)\n"\
+		" --patch <addr>=<hex bytes> | <addr>:<file>\n"\
+		"                patch bytes in place(repeat), one erase and program per touched block\n"\
+		" --skip-bad[=<addr>:<len>[:<reserve>]]\n"\
+		"                NAND addresses skip bad blocks like nandwrite, in the partition(default: whole chip)\n"\
+		"                with a reserve the logical size is the partition less reserve blocks\n"\
+		" --bbt <file>   bad block table for --skip-bad, saved from an OOB marker scan if not for the chip\n"\
+		" --ecc-region <addr>:<len>:<ecc|raw|raw+oob>\n"\
+		"                NAND ECC mode of a region(repeat), the rest ecc(raw+oob with -d), one image of all\n"\
+		" --direct[=<uring|threads>]\n"\
+		"                -r/-w file I/O past the page cache, dumps go to the file a chunk at a time\n";
 	printf(use);
 	exit(0);
 }
 
 int main(int argc, char* argv[])
 {
-	int c, vr = 0, svr = 0, ret = 0;
-	char *str, *fname = NULL, op = 0;
-	unsigned char *buf;
-	int long long len = 0, addr = 0, flen = 0, wlen = 0;
-	FILE *fp;
+	int c, vr = 0, svr = 0, plan = 0, cleanmarker = 0, blank_map = 0;
+	char *str, *fname = NULL, op = 0, *fw_index = NULL, *fw_image = NULL;
+	char *diff[DIFF_MAX], *chip = NULL, *best = NULL, **patch = NULL;
+	char *skip_part = NULL, *bbt = NULL, **ecc_region = NULL;
+	int ndiff = 0, npatch = 0, cycles = 0, pattern = BURNIN_PRNG, skip_bad = 0, necc = 0, direct = 0;
+	int addr_set = 0;
+	unsigned long long seed = time(NULL);
+	unsigned char *buf = NULL;
+	int long long len = 0, addr = 0, flen = 0, wlen = 0, ret = 0;
+	FILE *fp = NULL;
+#ifdef EEPROM_SUPPORT
+	char *i2c_bg = NULL;
+	int i2c_bg_on = 0;
+#endif
 
 	title();
 
 #ifdef EEPROM_SUPPORT
-	while ((c = getopt(argc, argv, "diIhveLl:a:w:r:E:f:8")) != -1)
+	while ((c = getopt_long(argc, argv, "diIhveTLl:a:w:r:E:f:8", long_opts, NULL)) != -1)
 #else
-	while ((c = getopt(argc, argv, "diIhveLl:a:w:r:")) != -1)
+	while ((c = getopt_long(argc, argv, "diIhveTLl:a:w:r:", long_opts, NULL)) != -1)
 #endif
 	{
 		switch(c)
@@ -140,6 +264,9 @@ int main(int argc, char* argv[])
 						exit(0);
 				}
 				break;
+			case OPT_I2C_WRITE:
+				i2c_bg = strdup(optarg);
+				break;
 #endif
 			case 'I':
 				ECC_ignore = 1;
@@ -155,10 +282,25 @@ int main(int argc, char* argv[])
 			case 'a':
 				str = strdup(optarg);
 				addr = strtoll(str, NULL, *str && *(str + 1) == 'x' ? 16 : 10);
+				addr_set = 1;
 				break;
 			case 'v':
 				vr = 1;
 				break;
+			case 'T':
+				stat_enable = 1;
+				break;
+			case OPT_PLAN:
+				plan = 1;
+				break;
+			case OPT_SIM:
+				sim_enable = 1;
+				if (optarg)
+					sim_image = strdup(optarg);
+				break;
+			case OPT_SIM_CHIP:
+				sim_chip = strdup(optarg);
+				break;
 			case 'i':
 			case 'e':
 				if(!op)
@@ -174,6 +316,121 @@ int main(int argc, char* argv[])
 				} else
 					op = 'x';
 				break;
+			case OPT_SERVE:
+				if(!op) {
+					op = 's';
+					fname = strdup(optarg);
+				} else
+					op = 'x';
+				break;
+			case OPT_FW_INDEX:
+				fw_index = strdup(optarg);
+				break;
+			case OPT_FW_ADD:
+				fw_image = strdup(optarg);
+				break;
+			case OPT_SPI_SPEED:
+				if ((spi_speed_forced = spi_speed_parse(optarg)) < 0)
+					exit(0);
+				spi_speed = spi_speed_forced;
+				break;
+			case OPT_FIXTURE:
+				spi_fixture = strdup(optarg);
+				break;
+			case OPT_CLEANMARKER:
+				cleanmarker = 1;
+				break;
+			case OPT_MARK_BAD:
+				if(!op)
+					op = 'b';
+				else
+					op = 'x';
+				break;
+			case OPT_DIFF:
+				if (ndiff == DIFF_MAX) {
+					printf("Too many dumps, at most %d.\n", DIFF_MAX);
+					exit(0);
+				}
+				diff[ndiff++] = strdup(optarg);
+				break;
+			case OPT_CHIP:
+				chip = strdup(optarg);
+				break;
+			case OPT_BEST:
+				best = strdup(optarg);
+				break;
+			case OPT_BLANK_MAP:
+				blank_map = 1;
+				/* fall through */
+			case OPT_BLANK:
+				if(!op)
+					op = 'k';
+				else if (op != 'k')
+					op = 'x';
+				break;
+			case OPT_FILL:
+				if(!op) {
+					op = 'p';
+					fname = strdup(optarg);
+				} else
+					op = 'x';
+				break;
+			case OPT_BURN_IN:
+				cycles = strtol(optarg, NULL, 0);
+				if (cycles <= 0) {
+					printf("Burn-in needs a number of cycles.\n");
+					exit(0);
+				}
+				if(!op)
+					op = 'n';
+				else
+					op = 'x';
+				break;
+			case OPT_PATTERN:
+				if ((pattern = burnin_parse_pattern(optarg)) < 0)
+					exit(0);
+				break;
+			case OPT_SEED:
+				seed = strtoull(optarg, NULL, 0);
+				break;
+			case OPT_PATCH:
+				if(!op)
+					op = 'c';
+				else if (op != 'c')
+					op = 'x';
+				if (!(patch = realloc(patch, (npatch + 1) * sizeof(*patch)))) {
+					printf("Malloc failed for patches.\n");
+					exit(0);
+				}
+				patch[npatch++] = strdup(optarg);
+				break;
+			case OPT_SKIP_BAD:
+				skip_bad = 1;
+				if (optarg)
+					skip_part = strdup(optarg);
+				break;
+			case OPT_BBT:
+				skip_bad = 1;
+				bbt = strdup(optarg);
+				break;
+			case OPT_ECC_REGION:
+				if (!(ecc_region = realloc(ecc_region, (necc + 1) * sizeof(*ecc_region)))) {
+					printf("Malloc failed for ECC regions.\n");
+					exit(0);
+				}
+				ecc_region[necc++] = strdup(optarg);
+				break;
+			case OPT_DIRECT:
+				if (dio_parse(optarg) < 0)
+					exit(0);
+				direct = 1;
+				break;
+			case OPT_FW_ID:
+				if(!op)
+					op = 'F';
+				else
+					op = 'x';
+				break;
 			case 'L':
 				support_flash_list();
 				exit(0);
@@ -183,20 +440,62 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	if ((fw_image || op == 'F') && !fw_index) {
+		printf("Firmware index file is not set, use --fw-index.\n\n");
+		return -1;
+	}
+
+	if (fw_image) {
+		str = strrchr(fw_image, '=');
+		if (str)
+			*str++ = 0;
+		else
+			str = (str = strrchr(fw_image, '/')) ? str + 1 : fw_image;
+		return fwid_add(fw_index, fw_image, str) < 0 ? -1 : 0;
+	}
+
+	if (ndiff)
+		return diff_run(diff, ndiff, chip, best, !ECC_fcheck) < 0 ? -1 : 0;
+
 	if (op == 0) usage();
 
+#ifdef EEPROM_SUPPORT
+	if (i2c_bg && (eepromsize > 0 || mw_eepromsize > 0))
+		op = 'x';
+#endif
+	/* OOB markers and the pattern fill address the chip blocks */
+	if ((skip_bad || necc) && (op == 'b' || op == 'p' || cleanmarker))
+		op = 'x';
+	if (skip_bad && necc)
+		op = 'x';
 	if (op == 'x' || (ECC_ignore && !ECC_fcheck) || (op == 'w' && ECC_ignore)) {
 		printf("Conflicting options, only one option at a time.\n\n");
 		return -1;
 	}
 
-	if (ch341a_spi_init() < 0) {
+	if (sim_enable) {
+		if (sim_attach() < 0)
+			return -1;
+	} else if (ch341a_spi_init() < 0) {
 		printf("Programmer device not found!\n\n");
 		return -1;
 	}
 
-	if((flen = flash_cmd_init(&prog)) <= 0)
+	if((flen = flash_cmd_init(&prog)) <= 0) {
+		ret = -1;
 		goto out;
+	}
+
+#ifdef EEPROM_SUPPORT
+	/* The EEPROM pages go out between the transactions of the SPI job */
+	if (i2c_bg && !plan) {
+		if (i2c_bg_start(i2c_bg) < 0) {
+			ret = -1;
+			goto out;
+		}
+		i2c_bg_on = 1;
+	}
+#endif
 
 #ifdef EEPROM_SUPPORT
 	if ((eepromsize || mw_eepromsize) && op == 'i') {
@@ -207,6 +506,173 @@ int main(int argc, char* argv[])
 	if (op == 'i') goto out;
 #endif
 
+	if (skip_bad) {
+		if (prog.flash_erase != snand_erase) {
+			printf("Bad block skipping is only for SPI NAND flash.\n");
+			goto out;
+		}
+		if (bb_attach(&prog, skip_part, bbt, &flen) < 0)
+			goto out;
+	}
+
+	if (necc) {
+		if (prog.flash_erase != snand_erase) {
+			printf("ECC regions are only for SPI NAND flash.\n");
+			goto out;
+		}
+		if (eccmap_attach(&prog, ecc_region, necc, &flen) < 0)
+			goto out;
+	}
+
+	if (op == 's') {
+		serve_run(&prog, flen, fname);
+		goto out;
+	}
+
+	if (op == 'F') {
+		fwid_identify(&prog, flen, fw_index);
+		goto out;
+	}
+
+	if ((op == 'b' || cleanmarker) && prog.flash_erase != snand_erase) {
+		printf("OOB markers are only for SPI NAND flash.\n");
+		goto out;
+	}
+
+	if (op == 'p' && prog.flash_erase != snand_erase) {
+		printf("Pattern fill is only for SPI NAND flash.\n");
+		goto out;
+	}
+
+	if (op == 'p') {
+		struct flash_info info;
+		unsigned char byte;
+
+		printf("PATTERN:\n");
+		if(addr && !len)
+			len = flen - addr;
+		else if(!addr && !len)
+			len = flen;
+		prog.flash_info(&info);
+		/* A number is a byte, anything else a file with (up to) one page */
+		byte = strtoul(fname, &str, 0);
+		if (*fname && !*str) {
+			buf = malloc(1);
+			wlen = 1;
+			if (buf)
+				*buf = byte;
+		} else if ((fp = fopen(fname, "rb"))) {
+			buf = malloc(info.page_size);
+			wlen = buf ? fread(buf, 1, info.page_size, fp) : 0;
+			fclose(fp);
+		} else {
+			printf("Couldn't open file %s for reading.\n", fname);
+			goto out;
+		}
+		if (!buf || wlen <= 0) {
+			printf("Pattern %s is empty.\n", fname);
+			free(buf);
+			goto out;
+		}
+		printf("Pattern addr = 0x%016llX, len = 0x%016llX, %lld byte pattern\n", addr, len, wlen);
+		if (plan) {
+			plan_run(&prog, 'w', 0, flen, addr, len, NULL, 0);
+			free(buf);
+			goto out;
+		}
+		ret = snand_program_pattern(addr, len, buf, wlen, 1);
+		sim_report("Pattern");
+		free(buf);
+		if(!ret)
+			printf("Status: OK\n");
+		else
+			printf("Status: BAD(%lld)\n", ret);
+		goto out;
+	}
+
+	if (op == 'b') {
+		struct flash_info info;
+
+		printf("MARK BAD:\n");
+		prog.flash_info(&info);
+		/* The mark is for good, a missing or odd address is not taken as block 0 */
+		if (!addr_set || addr % info.erase_size || addr >= flen) {
+			printf("Set the block to mark bad with -a <address>, a multiple of the block size 0x%08lX\n", info.erase_size);
+			goto out;
+		}
+		if (plan) {
+			printf("Would mark block %llu (0x%08llX) bad\n", addr / info.erase_size, addr);
+			goto out;
+		}
+		ret = snand_mark_bad(addr);
+		if(!ret)
+			printf("Status: OK\n");
+		else
+			printf("Status: BAD(%lld)\n", ret);
+		goto out;
+	}
+
+	if (op == 'k') {
+		printf("BLANK CHECK:\n");
+		if(addr && !len)
+			len = flen - addr;
+		else if(!addr && !len)
+			len = flen;
+		printf("Blank check addr = 0x%016llX, len = 0x%016llX\n", addr, len);
+		if (plan) {
+			plan_run(&prog, 'r', 0, flen, addr, len, NULL, 0);
+			goto out;
+		}
+		ret = blank_check(&prog, addr, len, blank_map);
+		sim_report("Blank check");
+		if (!ret)
+			printf("Status: OK\n");
+		else if (ret > 0)
+			printf("Status: NOT BLANK\n");
+		else
+			printf("Status: BAD(%lld)\n", ret);
+		goto out;
+	}
+
+	if (op == 'n') {
+		printf("BURN-IN:\n");
+		if(addr && !len)
+			len = flen - addr;
+		else if(!addr && !len)
+			len = flen;
+		printf("Burn-in addr = 0x%016llX, len = 0x%016llX\n", addr, len);
+		if (plan) {
+			plan_run(&prog, 'e', 0, flen, addr, len, NULL, 0);
+			plan_run(&prog, 'w', 1, flen, addr, len, NULL, 0);
+			goto out;
+		}
+		ret = burnin_run(&prog, addr, len, cycles, pattern, seed);
+		sim_report("Burn-in");
+		if(!ret)
+			printf("Status: OK\n");
+		else
+			printf("Status: BAD(%lld)\n", ret);
+		goto out;
+	}
+
+	if (op == 'c') {
+		printf("PATCH:\n");
+		wbc_attach(&prog, flen);
+		for (c = 0, ret = 0; c < npatch && !ret; c++)
+			ret = wbc_patch(&prog, patch[c]);
+		if (!ret)
+			ret = wbc_commit(vr, plan);
+		wbc_detach();
+		if (plan)
+			goto out;
+		sim_report("Patch");
+		if(!ret)
+			printf("Status: OK\n");
+		else
+			printf("Status: BAD(%lld)\n", ret);
+		goto out;
+	}
+
 	if (op == 'e') {
 		printf("ERASE:\n");
 		if(addr && !len)
@@ -215,16 +681,24 @@ int main(int argc, char* argv[])
 			len = flen;
 			printf("Set full erase chip!\n");
 		}
-		if(len % bsize) {
+		/* Across ECC regions the block size changes, the regions check it */
+		if(!necc && len % bsize) {
 			printf("Please set len = 0x%016llX multiple of the block size 0x%08X\n", len, bsize);
 			goto out;
 		}
 		printf("Erase addr = 0x%016llX, len = 0x%016llX\n", addr, len);
+		if (plan) {
+			plan_run(&prog, op, 0, flen, addr, len, NULL, 0);
+			goto out;
+		}
 		ret = prog.flash_erase(addr, len);
+		if (!ret && cleanmarker)
+			ret = snand_cleanmarker(addr, len);
+		sim_report("Erase");
 		if(!ret)
 			printf("Status: OK\n");
 		else
-			printf("Status: BAD(%d)\n", ret);
+			printf("Status: BAD(%lld)\n", ret);
 		goto out;
 	}
 
@@ -234,7 +708,11 @@ int main(int argc, char* argv[])
 		else if(!addr && !len) {
 			len = flen;
 		}
-		buf = (unsigned char *)malloc(len + 1);
+		/* A direct dump holds only its chunk buffers */
+		if (op == 'r' && direct)
+			goto very;
+		/* size_t is 32-bit on some hosts, a 16 Gbit NAND with OOB does not fit */
+		buf = (unsigned long long)len < (size_t)-1 ? (unsigned char *)malloc(len + 1) : NULL;
 		if (!buf) {
 			printf("Malloc failed for read buffer.\n");
 			goto out;
@@ -249,8 +727,11 @@ int main(int argc, char* argv[])
 			free(buf);
 			goto out;
 		}
-		wlen = fread(buf, 1, len, fp);
-		if (ferror(fp)) {
+		if (direct)
+			wlen = dio_load(fname, buf, len);
+		else
+			wlen = fread(buf, 1, len, fp);
+		if (wlen < 0 || ferror(fp)) {
 			printf("Error reading file [%s]\n", fname);
 			if (fp)
 				fclose(fp);
@@ -260,8 +741,16 @@ int main(int argc, char* argv[])
 		if(len == flen)
 			len = wlen;
 		printf("Write addr = 0x%016llX, len = 0x%016llX\n", addr, len);
+		if (plan) {
+			plan_run(&prog, op, vr, flen, addr, len, buf, wlen);
+			fclose(fp);
+			free(buf);
+			goto out;
+		}
 		ret = prog.flash_write(buf, addr, len);
+		sim_report("Write");
 		if(ret > 0) {
+			ret = 0;
 			printf("Status: OK\n");
 			if (vr) {
 				op = 'r';
@@ -270,8 +759,10 @@ int main(int argc, char* argv[])
 				goto very;
 			}
 		}
-		else
-			printf("Status: BAD(%d)\n", ret);
+		else {
+			printf("Status: BAD(%lld)\n", ret);
+			ret = -1;
+		}
 		fclose(fp);
 		free(buf);
 	}
@@ -281,15 +772,30 @@ very:
 		if (!svr) printf("READ:\n");
 		else memset(buf, 0, len);
 		printf("Read addr = 0x%016llX, len = 0x%016llX\n", addr, len);
+		if (plan) {
+			plan_run(&prog, op, 0, flen, addr, len, NULL, 0);
+			free(buf);
+			goto out;
+		}
+		if (direct && !svr) {
+			ret = dio_dump(&prog, fname, addr, len);
+			sim_report("Read");
+			if (!ret)
+				printf("Status: OK\n");
+			else
+				printf("Status: BAD(%lld)\n", ret);
+			goto out;
+		}
 		ret = prog.flash_read(buf, addr, len);
+		sim_report(svr ? "Verify" : "Read");
 		if (ret < 0) {
-			printf("Status: BAD(%d)\n", ret);
+			printf("Status: BAD(%lld)\n", ret);
 			free(buf);
 			goto out;
 		}
 		if (svr) {
 			unsigned char ch1;
-			int i = 0;
+			long long i = 0;
 
 			fseek(fp, 0, SEEK_SET);
 			ch1 = (unsigned char)getc(fp);
@@ -297,10 +803,17 @@ very:
 			while ((ch1 != EOF) && (i < len - 1) && (ch1 == buf[i++]))
 				ch1 = (unsigned char)getc(fp);
 
-			if (ch1 == buf[i])
+			if (ch1 == buf[i]) {
+				ret = 0;
 				printf("Status: OK\n");
-			else
+				spi_speed_save();
+			} else if (!spi_speed_retry(&prog, buf, addr, len, i ? i - 1 : 0)) {
+				/* A marginal link reads wrong, a bad write stays wrong */
+				goto very;
+			} else {
 				printf("Status: BAD\n");
+				ret = -1;
+			}
 			fclose(fp);
 			free(buf);
 			goto out;
@@ -316,10 +829,31 @@ very:
 			printf("Error writing file [%s]\n", fname);
 		fclose(fp);
 		free(buf);
+		ret = 0;
 		printf("Status: OK\n");
 	}
 
 out:
+	bb_detach();
+	eccmap_detach();
+#ifdef EEPROM_SUPPORT
+	if (i2c_bg_on) {
+		/* The SPI status stays in ret, a failed I2C write adds to it */
+		long long i2c_ret;
+
+		printf("I2C WRITE:\n");
+		i2c_ret = i2c_bg_finish(vr);
+		sim_report("I2C write");
+		if(!i2c_ret)
+			printf("Status: OK\n");
+		else
+			printf("Status: BAD(%lld)\n", i2c_ret);
+		if (!ret)
+			ret = i2c_ret;
+	}
+#endif
+	stat_report();
+	sim_detach();
 	ch341a_spi_shutdown();
-	return 0;
+	return ret ? -1 : 0;
 }
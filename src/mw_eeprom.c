@@ -25,12 +25,13 @@
 #include "bitbang_microwire.h"
 #include "ch341a_gpio.h"
 #include "timer.h"
+#include "flashcmd_api.h"
 
 extern struct gpio_cmd bb_func;
 extern char eepromname[12];
 extern unsigned int bsize;
 
-int mw_eeprom_read(unsigned char *buf, unsigned long from, unsigned long len)
+long long mw_eeprom_read(unsigned char *buf, unsigned long long from, unsigned long long len)
 {
 	unsigned char *pbuf, ebuf[MAX_MW_EEPROM_SIZE];
 
@@ -44,13 +45,13 @@ int mw_eeprom_read(unsigned char *buf, unsigned long from, unsigned long len)
 	Read_EEPROM_3wire(pbuf, mw_eepromsize);
 	memcpy(buf, pbuf + from, len);
 
-	printf("Read [%lu] bytes from [%s] EEPROM address 0x%08lu\n", len, eepromname, from);
+	printf("Read [%llu] bytes from [%s] EEPROM address 0x%08llX\n", len, eepromname, from);
 	timer_end();
 
-	return (int)len;
+	return len;
 }
 
-int mw_eeprom_erase(unsigned long offs, unsigned long len)
+int mw_eeprom_erase(unsigned long long offs, unsigned long long len)
 {
 	unsigned char *pbuf, ebuf[MAX_MW_EEPROM_SIZE];
 
@@ -70,18 +71,18 @@ int mw_eeprom_erase(unsigned long offs, unsigned long len)
 
 	if (offs || len < mw_eepromsize) {
 		if (Write_EEPROM_3wire(pbuf, mw_eepromsize) < 0) {
-			printf("Failed to erase [%lu] bytes of [%s] EEPROM address 0x%08lu\n", len, eepromname, offs);
+			printf("Failed to erase [%llu] bytes of [%s] EEPROM address 0x%08llX\n", len, eepromname, offs);
 			return -1;
 		}
 	}
 
-	printf("Erased [%lu] bytes of [%s] EEPROM address 0x%08lu\n", len, eepromname, offs);
+	printf("Erased [%llu] bytes of [%s] EEPROM address 0x%08llX\n", len, eepromname, offs);
 	timer_end();
 
 	return 0;
 }
 
-int mw_eeprom_write(unsigned char *buf, unsigned long to, unsigned long len)
+long long mw_eeprom_write(unsigned char *buf, unsigned long long to, unsigned long long len)
 {
 	unsigned char *pbuf, ebuf[MAX_MW_EEPROM_SIZE];
 
@@ -100,14 +101,14 @@ int mw_eeprom_write(unsigned char *buf, unsigned long to, unsigned long len)
 	Erase_EEPROM_3wire(mw_eepromsize);
 
 	if (Write_EEPROM_3wire(pbuf, mw_eepromsize) < 0) {
-		printf("Failed to write [%lu] bytes of [%s] EEPROM address 0x%08lu\n", len, eepromname, to);
+		printf("Failed to write [%llu] bytes of [%s] EEPROM address 0x%08llX\n", len, eepromname, to);
 		return -1;
 	}
 
-	printf("Wrote [%lu] bytes to [%s] EEPROM address 0x%08lu\n", len, eepromname, to);
+	printf("Wrote [%llu] bytes to [%s] EEPROM address 0x%08llX\n", len, eepromname, to);
 	timer_end();
 
-	return (int)len;
+	return len;
 }
 
 /*
@@ -155,7 +156,7 @@ static char *__itoa(int a)
 }
 
 
-long mw_init(void)
+long long mw_init(void)
 {
 	if (mw_eepromsize <= 0) {
 		printf("Microwire EEPROM Not Detected!\n");
@@ -170,7 +171,43 @@ long mw_init(void)
 	printf("Microwire EEPROM chip: %s, Size: %d bytes, Org: %d bits, fix addr len: %s\n", eepromname, mw_eepromsize / (org ? 2 : 1),
 			org ? 16 : 8, fix_addr_len ? __itoa(fix_addr_len) : "Auto");
 
-	return (long)mw_eepromsize;
+	return mw_eepromsize;
+}
+
+void mw_eeprom_info(struct flash_info *info)
+{
+	static struct chip_timing t;
+	unsigned long long us;
+	unsigned char b;
+	int i;
+
+	for (i = 0; mw_eepromlist[i].size; i++) {
+		if (strstr(mw_eepromlist[i].name, eepromname)) {
+			t.prog_typ  = mw_eepromlist[i].twc_typ;
+			t.prog_max  = mw_eepromlist[i].twc_max;
+			t.erase_typ = mw_eepromlist[i].tec_max;
+			t.erase_max = mw_eepromlist[i].tec_max;
+			break;
+		}
+	}
+
+	/* Every bit costs three GPIO round trips: clock low, data, clock high */
+	us = timer_usec();
+	for (i = 0; i < 16; i++)
+		bb_func.gpio_getbits(&b);
+	us = (timer_usec() - us) / 16;
+
+	memset(info, 0, sizeof(*info));
+	info->name       = eepromname;
+	info->page_size  = org ? 2 : 1;
+	info->erase_size = mw_eepromsize;
+	info->whole_chip = 1;
+	info->whole_write = 1;
+	info->read_op    = "READ 10b, sequential";
+	info->prog_op    = "EWEN + WRITE 01b per word";
+	info->erase_op   = "ERAL";
+	info->timing     = &t;
+	info->link_rate  = 1000000 / ((us ? us : 1) * 3 * 8);
 }
 
 void support_mw_eeprom_list(void)
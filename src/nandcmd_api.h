@@ -15,10 +15,29 @@
 #ifndef __NANDCMD_API_H__
 #define __NANDCMD_API_H__
 
-int snand_read(unsigned char *buf, unsigned long from, unsigned long len);
-int snand_erase(unsigned long offs, unsigned long len);
-int snand_write(unsigned char *buf, unsigned long to, unsigned long len);
-long snand_init(void);
+struct flash_info;
+
+/* Table geometry of a SPI NAND, page and erase sizes without the OOB */
+struct snand_geometry {
+	const char *name;
+	unsigned long long size;
+	unsigned long page_size;
+	unsigned long oob_size;
+	unsigned long erase_size;
+};
+
+long long snand_read(unsigned char *buf, unsigned long long from, unsigned long long len);
+int snand_erase(unsigned long long offs, unsigned long long len);
+long long snand_write(unsigned char *buf, unsigned long long to, unsigned long long len);
+long long snand_init(void);
+void snand_info(struct flash_info *info);
+int snand_cleanmarker(unsigned long long offs, unsigned long long len);
+int snand_mark_bad(unsigned long long offs);
+int snand_block_bad(unsigned long block);
+int snand_program_pattern(unsigned long long offs, unsigned long long len, const unsigned char *pattern, unsigned long plen, int fill);
+int snand_geometry(const char *name, struct snand_geometry *geo);
+void snand_ecc_geometry(struct snand_geometry *geo);
+void snand_ecc_mode(int on);
 void support_snand_list(void);
 
 extern int ECC_fcheck;
@@ -0,0 +1,174 @@
+/*
+ * plan.c
+ *
+ * Dry run planner: shows which units an operation touches, which opcodes
+ * are used and an ETA from the chip table timings and the link throughput.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "plan.h"
+#include "spi_controller.h"
+#include "timer.h"
+
+#define PLAN_PROBE_SIZE		8192
+
+struct plan_eta {
+	double typ;	/* usec */
+	double max;
+};
+
+/* Measure the raw SPI stream rate with chip select inactive */
+static unsigned long plan_link_rate(void)
+{
+	unsigned char buf[PLAN_PROBE_SIZE];
+	unsigned long long us;
+
+	us = timer_usec();
+	SPI_CONTROLLER_Read_NByte(buf, sizeof(buf), SPI_CONTROLLER_SPEED_SINGLE);
+	us = timer_usec() - us;
+
+	return (unsigned long)(sizeof(buf) * 1000000ULL / (us ? us : 1));
+}
+
+static const char *plan_time(char *out, int size, double us)
+{
+	unsigned long s = (unsigned long)(us / 1000000);
+
+	if (us < 1000000)
+		snprintf(out, size, "%.0f ms", us / 1000);
+	else if (s < 60)
+		snprintf(out, size, "%.1f s", us / 1000000);
+	else if (s < 3600)
+		snprintf(out, size, "%lu min %lu s", s / 60, s % 60);
+	else
+		snprintf(out, size, "%lu h %lu min", s / 3600, (s % 3600) / 60);
+
+	return out;
+}
+
+static void plan_erase(struct flash_info *info, const struct chip_timing *t,
+		       long long addr, long long len, struct plan_eta *eta)
+{
+	long long n = (len + info->erase_size - 1) / info->erase_size;
+
+	printf("Erase:   units %lld..%lld (%lld x %lu bytes), %s\n",
+		addr / info->erase_size, addr / info->erase_size + n - 1, n,
+		info->erase_size, info->erase_op);
+	eta->typ += n * (double)t->erase_typ;
+	eta->max += n * (double)t->erase_max;
+}
+
+static void plan_program(struct flash_info *info, const struct chip_timing *t, unsigned long rate,
+			 long long addr, long long len, const unsigned char *data, long long dlen,
+			 struct plan_eta *eta)
+{
+	long long first = addr / info->page_size, last = (addr + len - 1) / info->page_size;
+	long long p, i, from, to, n = 0, skipped = 0;
+	double xfer = (double)info->page_size * 1000000 / rate;
+
+	for (p = first; p <= last; p++) {
+		from = p * info->page_size > addr ? p * info->page_size - addr : 0;
+		to = (p + 1) * info->page_size - addr < len ? (p + 1) * info->page_size - addr : len;
+		if (info->skip_blank && data) {
+			for (i = from; i < to && i < dlen && data[i] == 0xff; i++)
+				;
+			if (i == to || i == dlen) {
+				skipped++;
+				continue;
+			}
+		}
+		n++;
+	}
+
+	printf("Program: units %lld..%lld (%lld x %lu bytes), %lld blank skipped, %s\n",
+		first, last, n, info->page_size, skipped, info->prog_op);
+	eta->typ += n * (t->prog_typ + xfer);
+	eta->max += n * (t->prog_max + xfer);
+	if (info->read_before_prog) {
+		printf("         each unit is read and merged first, %s\n", info->read_op);
+		eta->typ += n * (t->read_typ + xfer);
+		eta->max += n * (t->read_max + xfer);
+	}
+}
+
+static void plan_read(const char *what, struct flash_info *info, const struct chip_timing *t,
+		      unsigned long rate, long long addr, long long len, struct plan_eta *eta)
+{
+	long long n = (addr + len - 1) / info->page_size - addr / info->page_size + 1;
+	double xfer = (double)len * 1000000 / rate;
+
+	printf("%-8s units %lld..%lld (%lld x %lu bytes), %s\n", what,
+		addr / info->page_size, addr / info->page_size + n - 1, n, info->page_size, info->read_op);
+	eta->typ += n * (double)t->read_typ + xfer;
+	eta->max += n * (double)t->read_max + xfer;
+}
+
+void plan_run(struct flash_cmd *cmd, char op, int verify, long long flen,
+	      long long addr, long long len, const unsigned char *data, long long dlen)
+{
+	static const struct chip_timing none;
+	struct plan_eta eta = { 0, 0 };
+	const struct chip_timing *t;
+	struct flash_info info;
+	unsigned long rate;
+	char s1[32], s2[32];
+
+	if (!cmd->flash_info || len <= 0)
+		return;
+
+	cmd->flash_info(&info);
+	t = info.timing ? info.timing : &none;
+	rate = info.link_rate ? info.link_rate : plan_link_rate();
+
+	printf("PLAN:\n");
+	printf("Chip:    %s, program unit %lu bytes", info.name, info.page_size);
+	if (info.erase_size)
+		printf(", erase unit %lu bytes", info.erase_size);
+	printf("\nLink:    %lu bytes/s (%s)\n", rate, info.link_rate ? "modeled" : "measured");
+
+	/* Microwire EEPROMs are read and rewritten whole */
+	if (info.whole_write && op != 'r' && (addr || len < flen)) {
+		printf("         partial access, whole chip is read and rewritten\n");
+		plan_read("Read:", &info, t, rate, 0, flen, &eta);
+		data = NULL;
+	}
+	if (info.whole_write && op != 'r') {
+		addr = 0;
+		len = flen;
+	}
+
+	switch (op) {
+	case 'e':
+		if (info.erase_size)
+			plan_erase(&info, t, addr, len, &eta);
+		else
+			plan_program(&info, t, rate, addr, len, NULL, 0, &eta);
+		break;
+	case 'w':
+		if (info.whole_write && info.erase_size)
+			plan_erase(&info, t, 0, flen, &eta);
+		plan_program(&info, t, rate, addr, len, data, dlen, &eta);
+		if (verify)
+			plan_read("Verify:", &info, t, rate, addr, len, &eta);
+		break;
+	case 'r':
+		plan_read("Read:", &info, t, rate, addr, len, &eta);
+		break;
+	}
+
+	printf("ETA:     %s typical, %s worst case\n",
+		plan_time(s1, sizeof(s1), eta.typ), plan_time(s2, sizeof(s2), eta.max));
+}
+/* End of [plan.c] package */
@@ -0,0 +1,27 @@
+/*
+ * plan.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __PLAN_H__
+#define __PLAN_H__
+
+#include "flashcmd_api.h"
+
+/*
+ * Dry run: print the erase/program/read plan of an operation and its ETA.
+ * op is 'e', 'w' or 'r' as in main(), data/dlen is the file for 'w'.
+ */
+void plan_run(struct flash_cmd *cmd, char op, int verify, long long flen,
+	      long long addr, long long len, const unsigned char *data, long long dlen);
+
+#endif /* __PLAN_H__ */
+/* End of [plan.h] package */
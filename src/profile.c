@@ -0,0 +1,109 @@
+/*
+ * profile.c
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+
+#define PROFILE_LINE	256
+#define PROFILE_MAX	1024
+#define PROFILE_KEY	200
+
+static const char *profile_path(void)
+{
+	static char path[512];
+	const char *home;
+
+	if ((home = getenv("SNANDER_PROFILE")) != NULL)
+		return home;
+	if ((home = getenv("HOME")) == NULL && (home = getenv("USERPROFILE")) == NULL)
+		return NULL;
+	snprintf(path, sizeof(path), "%s/.snander_profile", home);
+	return path;
+}
+
+/* Key is "<chip>.<key>" with blanks in chip names replaced by '_' */
+static void profile_key(char *out, int size, const char *chip, const char *key)
+{
+	char *p;
+
+	snprintf(out, size, "%s.%s", chip, key);
+	for (p = out; *p; p++)
+		if (*p == ' ' || *p == '\t')
+			*p = '_';
+}
+
+int profile_get(const char *chip, const char *key, unsigned long *val)
+{
+	char line[PROFILE_LINE], name[PROFILE_LINE], k[PROFILE_KEY];
+	const char *path = profile_path();
+	unsigned long v;
+	FILE *fp;
+	int ret = -1;
+
+	if (!path || !(fp = fopen(path, "r")))
+		return -1;
+
+	profile_key(k, sizeof(k), chip, key);
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%255s %lu", name, &v) == 2 && !strcmp(name, k)) {
+			*val = v;
+			ret = 0;
+		}
+	}
+	fclose(fp);
+
+	return ret;
+}
+
+int profile_set(const char *chip, const char *key, unsigned long val)
+{
+	static char lines[PROFILE_MAX][PROFILE_LINE];
+	char name[PROFILE_LINE], k[PROFILE_KEY];
+	const char *path = profile_path();
+	int i, n = 0, found = 0;
+	FILE *fp;
+
+	if (!path)
+		return -1;
+
+	profile_key(k, sizeof(k), chip, key);
+	if ((fp = fopen(path, "r")) != NULL) {
+		while (n < PROFILE_MAX && fgets(lines[n], PROFILE_LINE, fp)) {
+			if (sscanf(lines[n], "%255s", name) == 1 && !strcmp(name, k)) {
+				if (found)
+					continue;
+				snprintf(lines[n], PROFILE_LINE, "%s %lu\n", k, val);
+				found = 1;
+			}
+			n++;
+		}
+		fclose(fp);
+	}
+	if (!found && n < PROFILE_MAX)
+		snprintf(lines[n++], PROFILE_LINE, "%s %lu\n", k, val);
+
+	if (!(fp = fopen(path, "w"))) {
+		printf("Couldn't open file %s for writing.\n", path);
+		return -1;
+	}
+	for (i = 0; i < n; i++)
+		fputs(lines[i], fp);
+	fclose(fp);
+
+	return 0;
+}
+/* End of [profile.c] package */
@@ -0,0 +1,25 @@
+/*
+ * profile.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+/*
+ * Small persistent "key value" store for per-chip tuning learned at run time.
+ * Stored in $SNANDER_PROFILE, or ~/.snander_profile by default.
+ */
+int profile_get(const char *chip, const char *key, unsigned long *val);
+int profile_set(const char *chip, const char *key, unsigned long val);
+
+#endif /* __PROFILE_H__ */
+/* End of [profile.h] package */
@@ -0,0 +1,364 @@
+/*
+ * serve.c
+ *
+ * Random access read service: the chip is read on demand through an LRU
+ * cache of read units with sequential readahead, so only the regions a
+ * client touches cross USB.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "serve.h"
+#include "timer.h"
+
+#ifndef _WIN32
+
+#include <signal.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SERVE_MIN_UNIT		4096
+#define SERVE_CACHE_UNITS	256
+#define SERVE_HASH		512
+#define SERVE_READAHEAD_MAX	32	/* units */
+#define SERVE_LINE		128
+
+struct serve_slot {
+	unsigned long long unit;
+	int prev, next;		/* LRU list, head is the most recent */
+	int hnext;		/* hash chain */
+	int used;
+};
+
+static struct {
+	struct flash_cmd *cmd;
+	const char *name;
+	unsigned long long size;
+	unsigned long unit;
+	unsigned char *data;
+	int nslots;
+	struct serve_slot slot[SERVE_CACHE_UNITS];
+	int hash[SERVE_HASH];
+	int head, tail;
+	unsigned long long next_unit;	/* sequential access detection */
+	int window;			/* readahead, units */
+	unsigned long hits, misses, units_read;
+	unsigned long long bytes_read;
+} sv;
+
+static void serve_unlink(int s)
+{
+	struct serve_slot *p = &sv.slot[s];
+
+	if (p->prev >= 0)
+		sv.slot[p->prev].next = p->next;
+	else
+		sv.head = p->next;
+	if (p->next >= 0)
+		sv.slot[p->next].prev = p->prev;
+	else
+		sv.tail = p->prev;
+}
+
+static void serve_push_head(int s)
+{
+	sv.slot[s].prev = -1;
+	sv.slot[s].next = sv.head;
+	if (sv.head >= 0)
+		sv.slot[sv.head].prev = s;
+	sv.head = s;
+	if (sv.tail < 0)
+		sv.tail = s;
+}
+
+static int serve_lookup(unsigned long long unit)
+{
+	int s;
+
+	for (s = sv.hash[unit % SERVE_HASH]; s >= 0; s = sv.slot[s].hnext)
+		if (sv.slot[s].unit == unit)
+			return s;
+	return -1;
+}
+
+static void serve_hash_del(int s)
+{
+	int *p = &sv.hash[sv.slot[s].unit % SERVE_HASH];
+
+	while (*p != s)
+		p = &sv.slot[*p].hnext;
+	*p = sv.slot[s].hnext;
+}
+
+/* Take the least recently used slot for a new unit */
+static int serve_alloc(unsigned long long unit)
+{
+	int s = sv.tail;
+
+	serve_unlink(s);
+	if (sv.slot[s].used)
+		serve_hash_del(s);
+	sv.slot[s].used = 1;
+	sv.slot[s].unit = unit;
+	sv.slot[s].hnext = sv.hash[unit % SERVE_HASH];
+	sv.hash[unit % SERVE_HASH] = s;
+	serve_push_head(s);
+
+	return s;
+}
+
+/* Read n uncached units starting at first with one driver call */
+static int serve_fill(unsigned long long first, unsigned long n)
+{
+	unsigned long long off = first * sv.unit, len = (unsigned long long)n * sv.unit;
+	unsigned char *buf;
+	unsigned long i;
+	long long ret;
+
+	if (off + len > sv.size)
+		len = sv.size - off;
+	if (!(buf = malloc(n * sv.unit)))
+		return -1;
+	memset(buf, 0xff, n * sv.unit);
+
+	timer_mute(1);
+	ret = sv.cmd->flash_read(buf, off, len);
+	timer_mute(0);
+	if (ret < 0) {
+		free(buf);
+		return -1;
+	}
+
+	for (i = 0; i < n; i++)
+		memcpy(sv.data + (unsigned long)serve_alloc(first + i) * sv.unit, buf + i * sv.unit, sv.unit);
+	free(buf);
+
+	sv.units_read += n;
+	sv.bytes_read += len;
+	return 0;
+}
+
+static int serve_read(unsigned char *out, unsigned long long off, unsigned long len)
+{
+	unsigned long long u, first = off / sv.unit, last = (off + len - 1) / sv.unit;
+	unsigned long units = (sv.size + sv.unit - 1) / sv.unit, n, from, cnt;
+	int s;
+
+	/* Readahead window doubles while the access stays sequential */
+	if (first == sv.next_unit)
+		sv.window = sv.window ? sv.window * 2 : 1;
+	else
+		sv.window = 0;
+	if (sv.window > SERVE_READAHEAD_MAX)
+		sv.window = SERVE_READAHEAD_MAX;
+
+	for (u = first; u <= last; u++) {
+		if ((s = serve_lookup(u)) < 0) {
+			sv.misses++;
+			for (n = 1; n < sv.nslots / 2 && u + n < units &&
+			     u + n <= last + sv.window && serve_lookup(u + n) < 0; n++)
+				;
+			if (serve_fill(u, n) < 0)
+				return -1;
+			s = serve_lookup(u);
+		} else {
+			sv.hits++;
+			serve_unlink(s);
+			serve_push_head(s);
+		}
+
+		from = u == first ? off % sv.unit : 0;
+		cnt = sv.unit - from;
+		if (cnt > len)
+			cnt = len;
+		memcpy(out, sv.data + (unsigned long)s * sv.unit + from, cnt);
+		out += cnt;
+		len -= cnt;
+	}
+	sv.next_unit = last + 1;
+
+	return 0;
+}
+
+static int serve_send(int fd, const void *buf, unsigned long len)
+{
+	const unsigned char *p = buf;
+	ssize_t n;
+
+	while (len) {
+		if ((n = write(fd, p, len)) <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+static int serve_reply(int fd, const char *fmt, ...)
+{
+	char line[SERVE_LINE * 2];
+	va_list ap;
+
+	va_start(ap, fmt);
+	vsnprintf(line, sizeof(line), fmt, ap);
+	va_end(ap);
+
+	return serve_send(fd, line, strlen(line));
+}
+
+static int serve_getline(int fd, char *line, int size)
+{
+	int n = 0;
+	char c;
+
+	while (read(fd, &c, 1) == 1) {
+		if (c == '\n') {
+			line[n] = 0;
+			return n;
+		}
+		if (n < size - 1)
+			line[n++] = c;
+	}
+	return -1;
+}
+
+/* Handle one client, returns 1 on QUIT */
+static int serve_client(int fd, unsigned char *buf)
+{
+	char line[SERVE_LINE];
+	unsigned long long off;
+	unsigned long len;
+
+	while (serve_getline(fd, line, sizeof(line)) >= 0) {
+		if (!strcmp(line, "INFO")) {
+			serve_reply(fd, "OK %llu %lu %s\n", sv.size, sv.unit, sv.name);
+		} else if (!strcmp(line, "STAT")) {
+			serve_reply(fd, "OK %lu %lu %lu %llu\n", sv.hits, sv.misses, sv.units_read, sv.bytes_read);
+		} else if (!strcmp(line, "QUIT")) {
+			serve_reply(fd, "OK\n");
+			return 1;
+		} else if (sscanf(line, "READ %llu %lu", &off, &len) == 2) {
+			if (!len || len > SERVE_MAX_READ || off >= sv.size || len > sv.size - off) {
+				serve_reply(fd, "ERR bad range\n");
+				continue;
+			}
+			if (serve_read(buf, off, len) < 0) {
+				serve_reply(fd, "ERR read failed\n");
+				continue;
+			}
+			if (serve_reply(fd, "OK %lu\n", len) < 0 || serve_send(fd, buf, len) < 0)
+				break;
+		} else {
+			serve_reply(fd, "ERR unknown command\n");
+		}
+	}
+	return 0;
+}
+
+int serve_run(struct flash_cmd *cmd, long long flen, const char *path)
+{
+	struct sockaddr_un sa;
+	struct flash_info info;
+	unsigned char *buf;
+	int i, s, fd, quit = 0;
+
+	memset(&sv, 0, sizeof(sv));
+	sv.cmd = cmd;
+	sv.size = flen;
+	sv.name = "unknown";
+	sv.unit = SERVE_MIN_UNIT;
+	if (cmd->flash_info) {
+		cmd->flash_info(&info);
+		sv.name = info.name;
+		/* Whole chip readers are cached as one unit */
+		if (info.whole_chip)
+			sv.unit = flen;
+		else if (info.page_size > SERVE_MIN_UNIT)
+			sv.unit = info.page_size;
+	}
+	if (sv.unit > flen)
+		sv.unit = flen;
+	sv.nslots = (flen + sv.unit - 1) / sv.unit;
+	if (sv.nslots > SERVE_CACHE_UNITS)
+		sv.nslots = SERVE_CACHE_UNITS;
+
+	for (i = 0; i < SERVE_HASH; i++)
+		sv.hash[i] = -1;
+	sv.head = sv.tail = -1;
+	for (i = 0; i < sv.nslots; i++)
+		serve_push_head(i);
+	sv.next_unit = ~0ULL;
+
+	sv.data = malloc((unsigned long)sv.nslots * sv.unit);
+	buf = malloc(SERVE_MAX_READ);
+	if (!sv.data || !buf) {
+		printf("Malloc failed for read cache.\n");
+		free(sv.data);
+		free(buf);
+		return -1;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(sa.sun_path)) {
+		printf("Socket path %s is too long.\n", path);
+		goto err;
+	}
+	strcpy(sa.sun_path, path);
+	unlink(path);
+	if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		printf("Couldn't create socket.\n");
+		goto err;
+	}
+	if (bind(s, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(s, 1) < 0) {
+		printf("Couldn't listen on socket %s.\n", path);
+		close(s);
+		goto err;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	printf("Serving %s, %llu bytes, cache %d x %lu bytes on %s\n", sv.name, sv.size,
+		sv.nslots, sv.unit, path);
+	fflush(stdout);
+	while (!quit && (fd = accept(s, NULL, NULL)) >= 0) {
+		quit = serve_client(fd, buf);
+		close(fd);
+	}
+	close(s);
+	unlink(path);
+
+	printf("Served: %lu hits, %lu misses, %lu units (%llu of %llu bytes) read from the chip\n",
+		sv.hits, sv.misses, sv.units_read, sv.bytes_read, sv.size);
+	free(sv.data);
+	free(buf);
+	return 0;
+err:
+	free(sv.data);
+	free(buf);
+	return -1;
+}
+
+#else
+
+int serve_run(struct flash_cmd *cmd, long long flen, const char *path)
+{
+	printf("Read service is not supported on this platform.\n");
+	return -1;
+}
+
+#endif
+/* End of [serve.c] package */
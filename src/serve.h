@@ -0,0 +1,24 @@
+/*
+ * serve.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __SERVE_H__
+#define __SERVE_H__
+
+#include "flashcmd_api.h"
+#include "serve_client.h"
+
+/* Serve reads of the attached chip on a Unix socket until QUIT */
+int serve_run(struct flash_cmd *cmd, long long flen, const char *path);
+
+#endif /* __SERVE_H__ */
+/* End of [serve.h] package */
@@ -0,0 +1,143 @@
+/*
+ * serve_client.c
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "serve_client.h"
+
+#define CLIENT_LINE	128
+
+static int client_send(int fd, const char *line)
+{
+	size_t len = strlen(line);
+	ssize_t n;
+
+	while (len) {
+		if ((n = write(fd, line, len)) <= 0)
+			return -1;
+		line += n;
+		len -= n;
+	}
+	return 0;
+}
+
+static int client_recv(int fd, void *buf, unsigned long len)
+{
+	unsigned char *p = buf;
+	ssize_t n;
+
+	while (len) {
+		if ((n = read(fd, p, len)) <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/* Send a request and read the status line, returns 0 on OK */
+static int client_request(struct snander_client *c, const char *req, char *line, int size)
+{
+	int n = 0;
+	char ch;
+
+	if (client_send(c->fd, req) < 0)
+		return -1;
+	while (read(c->fd, &ch, 1) == 1) {
+		if (ch == '\n') {
+			line[n] = 0;
+			return strncmp(line, "OK", 2) ? -1 : 0;
+		}
+		if (n < size - 1)
+			line[n++] = ch;
+	}
+	return -1;
+}
+
+int snander_open(struct snander_client *c, const char *path)
+{
+	struct sockaddr_un sa;
+	char line[CLIENT_LINE];
+
+	memset(c, 0, sizeof(*c));
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(sa.sun_path))
+		return -1;
+	strcpy(sa.sun_path, path);
+
+	if ((c->fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return -1;
+	if (connect(c->fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 ||
+	    client_request(c, "INFO\n", line, sizeof(line)) < 0 ||
+	    sscanf(line, "OK %llu %lu %63[^\n]", &c->size, &c->unit, c->name) != 3) {
+		close(c->fd);
+		c->fd = -1;
+		return -1;
+	}
+	return 0;
+}
+
+long snander_pread(struct snander_client *c, void *buf, unsigned long len, unsigned long long offset)
+{
+	char req[CLIENT_LINE], line[CLIENT_LINE];
+	unsigned long done = 0, n, got;
+
+	if (offset >= c->size)
+		return 0;
+	if (len > c->size - offset)
+		len = c->size - offset;
+
+	while (done < len) {
+		n = len - done > SERVE_MAX_READ ? SERVE_MAX_READ : len - done;
+		snprintf(req, sizeof(req), "READ %llu %lu\n", offset + done, n);
+		if (client_request(c, req, line, sizeof(line)) < 0 ||
+		    sscanf(line, "OK %lu", &got) != 1 || got != n ||
+		    client_recv(c->fd, (unsigned char *)buf + done, n) < 0)
+			return -1;
+		done += n;
+	}
+	return (long)done;
+}
+
+int snander_stat(struct snander_client *c, unsigned long *hits, unsigned long *misses,
+		 unsigned long long *bytes_read)
+{
+	char line[CLIENT_LINE];
+	unsigned long units;
+
+	if (client_request(c, "STAT\n", line, sizeof(line)) < 0 ||
+	    sscanf(line, "OK %lu %lu %lu %llu", hits, misses, &units, bytes_read) != 4)
+		return -1;
+	return 0;
+}
+
+int snander_quit(struct snander_client *c)
+{
+	char line[CLIENT_LINE];
+
+	return client_request(c, "QUIT\n", line, sizeof(line));
+}
+
+void snander_close(struct snander_client *c)
+{
+	if (c->fd >= 0)
+		close(c->fd);
+	c->fd = -1;
+}
+/* End of [serve_client.c] package */
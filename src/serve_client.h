@@ -0,0 +1,52 @@
+/*
+ * serve_client.h
+ *
+ * Client side of the SNANDer read service (SNANDer --serve <path>).
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __SERVE_CLIENT_H__
+#define __SERVE_CLIENT_H__
+
+/*
+ * Read service protocol, one request line per command:
+ *   INFO                  -> OK <size> <cache unit> <chip name>
+ *   READ <offset> <len>   -> OK <len>, followed by <len> data bytes
+ *   STAT                  -> OK <hits> <misses> <units read> <bytes read>
+ *   QUIT                  -> OK, the server exits
+ * Errors are answered with ERR <message>.
+ */
+#define SERVE_MAX_READ		(16 * 1024 * 1024)
+
+struct snander_client {
+	int fd;
+	unsigned long long size;	/* chip size, bytes */
+	unsigned long unit;		/* server cache unit, bytes */
+	char name[64];			/* chip name */
+};
+
+/* Connect and query the chip, returns 0 or -1 */
+int snander_open(struct snander_client *c, const char *path);
+
+/* Read len bytes at offset, returns the byte count or -1 */
+long snander_pread(struct snander_client *c, void *buf, unsigned long len, unsigned long long offset);
+
+/* Cache statistics of the server */
+int snander_stat(struct snander_client *c, unsigned long *hits, unsigned long *misses,
+		 unsigned long long *bytes_read);
+
+/* Stop the server */
+int snander_quit(struct snander_client *c);
+
+void snander_close(struct snander_client *c);
+
+#endif /* __SERVE_CLIENT_H__ */
+/* End of [serve_client.h] package */
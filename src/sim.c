@@ -0,0 +1,363 @@
+/*
+ * sim.c
+ *
+ * Simulated CH341A: decodes the I2C, UIO and SPI stream packets the drivers
+ * send and runs them against a device model, on a modeled clock. Every
+ * blocking bulk transfer counts as one USB round trip.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+
+#define SIM_PACKET_LENGTH	32
+#define SIM_FIFO_SIZE		8192
+
+#define SIM_CMD_SPI_STREAM	0xA8
+#define SIM_CMD_I2C_STREAM	0xAA
+#define SIM_CMD_UIO_STREAM	0xAB
+
+#define SIM_I2C_STM_STA		0x74
+#define SIM_I2C_STM_STO		0x75
+#define SIM_I2C_STM_OUT		0x80
+#define SIM_I2C_STM_IN		0xC0
+#define SIM_I2C_STM_SET		0x60
+#define SIM_I2C_STM_MS		0x50
+#define SIM_I2C_STM_US		0x40
+#define SIM_I2C_STM_END		0x00
+
+#define SIM_UIO_STM_IN		0x00
+#define SIM_UIO_STM_DIR		0x40
+#define SIM_UIO_STM_OUT		0x80
+#define SIM_UIO_STM_US		0xC0
+#define SIM_UIO_STM_END		0x20
+
+#define SIM_UIO_DO		0x80
+
+#ifdef EEPROM_SUPPORT
+extern int eepromsize;
+extern int mw_eepromsize;
+#endif
+
+int sim_enable = 0;
+char *sim_image = NULL;
+char *sim_chip = NULL;
+unsigned long long sim_now = 0;
+
+struct sim_count {
+	unsigned long out, in;
+	unsigned long long usb, bus, delay;	/* nsec */
+	unsigned long nack, bad;
+};
+
+static struct sim_count sim_total, sim_last;
+static struct sim_dev *sim_dev;
+static struct sim_dev *sim_i2c_dev;	/* sim_dev or an I2C companion */
+static uint8_t *sim_mem, *sim_i2c_mem;
+static uint64_t sim_size;
+
+/* Bytes the stream engines produced for the next bulk IN */
+static uint8_t sim_fifo[SIM_FIFO_SIZE];
+static int sim_fifo_len;
+
+/* I2C bit time in nsec for 20kHz, 100kHz, 400kHz, 750kHz */
+static const unsigned long long sim_i2c_bit_ns[4] = { 50000, 10000, 2500, 1333 };
+static unsigned long long sim_i2c_bit = 10000;
+
+/* SPI bit time in nsec for the same speed field, the fastest is the ~1.5MHz clock of the CH341A */
+static const unsigned long long sim_spi_bit_ns[4] = { 5333, 2667, 1333, 667 };
+static unsigned long long sim_spi_bit = 667;
+
+static uint8_t sim_uio_out, sim_uio_dir;
+static int sim_cs;
+
+static void sim_advance(unsigned long long ns, unsigned long long *what)
+{
+	sim_now += ns;
+	*what += ns;
+}
+
+static void sim_push(uint8_t b)
+{
+	if (sim_fifo_len < SIM_FIFO_SIZE)
+		sim_fifo[sim_fifo_len++] = b;
+}
+
+/* The CH341A shifts SPI bytes LSB first, the driver swaps them */
+static uint8_t sim_swap(uint8_t x)
+{
+	x = ((x >> 1) & 0x55) | ((x << 1) & 0xaa);
+	x = ((x >> 2) & 0x33) | ((x << 2) & 0xcc);
+	x = ((x >> 4) & 0x0f) | ((x << 4) & 0xf0);
+	return x;
+}
+
+/* CS is D0 driven low; the driver deselects by tri-stating the pins */
+static void sim_uio_cs(void)
+{
+	int active = (sim_uio_dir & 0x01) && !(sim_uio_out & 0x01);
+
+	if (active == sim_cs)
+		return;
+	sim_cs = active;
+	if (sim_dev->spi_cs)
+		sim_dev->spi_cs(active);
+}
+
+static void sim_i2c_packet(const uint8_t *p, int len)
+{
+	int i, n;
+	uint8_t c;
+
+	for (i = 1; i < len; i++) {
+		c = p[i];
+		if (c == SIM_I2C_STM_END)
+			return;
+		if ((c & 0xC0) == SIM_I2C_STM_OUT) {
+			n = c & 0x3F;
+			if (i + n >= len) {
+				/* OUT data crosses the packet boundary */
+				sim_total.bad++;
+				n = len - i - 1;
+			}
+			while (n--) {
+				if (!sim_i2c_dev->i2c_write || !sim_i2c_dev->i2c_write(p[++i]))
+					sim_total.nack++;
+				sim_advance(9 * sim_i2c_bit, &sim_total.bus);
+			}
+		} else if ((c & 0xC0) == SIM_I2C_STM_IN) {
+			/* IN with length 0 reads one byte and NAKs it */
+			for (n = (c & 0x3F) ? (c & 0x3F) : 1; n; n--) {
+				sim_push(sim_i2c_dev->i2c_read ? sim_i2c_dev->i2c_read() : 0xFF);
+				sim_advance(9 * sim_i2c_bit, &sim_total.bus);
+			}
+		} else if (c == SIM_I2C_STM_STA) {
+			if (sim_i2c_dev->i2c_start)
+				sim_i2c_dev->i2c_start();
+			sim_advance(sim_i2c_bit, &sim_total.bus);
+		} else if (c == SIM_I2C_STM_STO) {
+			if (sim_i2c_dev->i2c_stop)
+				sim_i2c_dev->i2c_stop();
+			sim_advance(sim_i2c_bit, &sim_total.bus);
+		} else if ((c & 0xF0) == SIM_I2C_STM_SET) {
+			sim_i2c_bit = sim_i2c_bit_ns[c & 0x03];
+			sim_spi_bit = sim_spi_bit_ns[c & 0x03];
+		} else if ((c & 0xF0) == SIM_I2C_STM_MS) {
+			sim_advance((c & 0x0F) * 1000000ULL, &sim_total.delay);
+		} else if ((c & 0xF0) == SIM_I2C_STM_US) {
+			sim_advance((c & 0x0F) * 1000ULL, &sim_total.delay);
+		} else {
+			sim_total.bad++;
+		}
+	}
+}
+
+static void sim_uio_packet(const uint8_t *p, int len)
+{
+	int i;
+	uint8_t c;
+
+	for (i = 1; i < len; i++) {
+		c = p[i];
+		if (c == SIM_UIO_STM_END)
+			return;
+		switch (c & 0xC0) {
+		case SIM_UIO_STM_IN:
+			if (c != SIM_UIO_STM_IN) {
+				sim_total.bad++;
+				break;
+			}
+			/* Unconnected D7 is pulled up */
+			sim_push(sim_uio_out | ((!sim_dev->uio_in || sim_dev->uio_in()) ? SIM_UIO_DO : 0));
+			break;
+		case SIM_UIO_STM_DIR:
+			sim_uio_dir = c & 0x3F;
+			sim_uio_cs();
+			break;
+		case SIM_UIO_STM_OUT:
+			sim_uio_out = c & 0x3F;
+			if (sim_dev->uio_pins)
+				sim_dev->uio_pins(sim_uio_out & sim_uio_dir);
+			sim_uio_cs();
+			break;
+		case SIM_UIO_STM_US:
+			sim_advance((c & 0x3F) * 1000ULL, &sim_total.delay);
+			break;
+		}
+	}
+}
+
+static void sim_packet(const uint8_t *p, int len)
+{
+	int i;
+
+	switch (p[0]) {
+	case SIM_CMD_I2C_STREAM:
+		sim_i2c_packet(p, len);
+		break;
+	case SIM_CMD_UIO_STREAM:
+		sim_uio_packet(p, len);
+		break;
+	case SIM_CMD_SPI_STREAM:
+		/* Deselected or no SPI device: MISO floats high */
+		for (i = 1; i < len; i++) {
+			sim_push(sim_cs && sim_dev->spi_xfer ? sim_swap(sim_dev->spi_xfer(sim_swap(p[i]))) : 0xFF);
+			sim_advance(8 * sim_spi_bit, &sim_total.bus);
+		}
+		break;
+	}
+}
+
+int sim_bulk_transfer(uint8_t ep, uint8_t *buf, int len)
+{
+	int i, n;
+
+	if (ep & 0x80) {
+		n = len < sim_fifo_len ? len : sim_fifo_len;
+		memcpy(buf, sim_fifo, n);
+		memmove(sim_fifo, sim_fifo + n, sim_fifo_len - n);
+		sim_fifo_len -= n;
+		sim_total.in++;
+	} else if (sim_dev) {
+		for (i = 0; i < len; i += SIM_PACKET_LENGTH)
+			sim_packet(buf + i, len - i < SIM_PACKET_LENGTH ? len - i : SIM_PACKET_LENGTH);
+		n = len;
+		sim_total.out++;
+	} else
+		return -1;
+	sim_advance(SIM_USB_RTT_NS + n * SIM_USB_BYTE_NS, &sim_total.usb);
+
+	return n;
+}
+
+int sim_attach(void)
+{
+	FILE *fp = NULL;
+	uint32_t size;
+	int ret;
+
+	sim_dev = &sim_snand;
+#ifdef EEPROM_SUPPORT
+	if (eepromsize > 0)
+		sim_dev = &sim_24cxx;
+	else if (mw_eepromsize > 0)
+		sim_dev = &sim_93cxx;
+#endif
+	if (sim_image)
+		fp = fopen(sim_image, "rb");
+
+	if (sim_dev->open) {
+		ret = sim_dev->open(fp, &sim_size);
+		if (fp)
+			fclose(fp);
+		if (ret < 0) {
+			sim_dev = NULL;
+			return -1;
+		}
+	} else {
+		if (!(sim_mem = sim_dev->attach(&size))) {
+			if (fp)
+				fclose(fp);
+			return -1;
+		}
+		sim_size = size;
+		if (fp) {
+			if (fread(sim_mem, 1, size, fp) != size)
+				printf("Simulator image %s is shorter than the chip, rest is blank.\n", sim_image);
+			fclose(fp);
+		}
+	}
+	printf("Simulated programmer: CH341A, %s, %llu bytes\n", sim_dev->name, (unsigned long long)sim_size);
+	sim_i2c_dev = sim_dev;
+
+	return 0;
+}
+
+int sim_attach_i2c(struct sim_dev *dev)
+{
+	uint32_t size;
+
+	if (!(sim_i2c_mem = dev->attach(&size)))
+		return -1;
+	sim_i2c_dev = dev;
+	printf("Simulated I2C companion: %s, %u bytes\n", dev->name, size);
+
+	return 0;
+}
+
+void sim_sleep(unsigned long long ns)
+{
+	sim_advance(ns, &sim_total.delay);
+}
+
+void sim_detach(void)
+{
+	FILE *fp = NULL;
+
+	if (!sim_enable || !sim_dev)
+		return;
+
+	free(sim_i2c_mem);
+	sim_i2c_mem = NULL;
+	sim_i2c_dev = NULL;
+
+	if (sim_dev->close) {
+		if (sim_image && !(fp = fopen(sim_image, "wb")))
+			printf("Couldn't open file %s for writing.\n", sim_image);
+		sim_dev->close(fp);
+		if (fp)
+			fclose(fp);
+		sim_dev = NULL;
+		return;
+	}
+	if (!sim_mem)
+		return;
+
+	if (sim_image) {
+		if ((fp = fopen(sim_image, "wb")) != NULL) {
+			fwrite(sim_mem, 1, sim_size, fp);
+			fclose(fp);
+		} else
+			printf("Couldn't open file %s for writing.\n", sim_image);
+	}
+	free(sim_mem);
+	sim_mem = NULL;
+}
+
+void sim_report(const char *op)
+{
+	struct sim_count d;
+
+	if (!sim_enable)
+		return;
+
+	d.out = sim_total.out - sim_last.out;
+	d.in = sim_total.in - sim_last.in;
+	d.usb = sim_total.usb - sim_last.usb;
+	d.bus = sim_total.bus - sim_last.bus;
+	d.delay = sim_total.delay - sim_last.delay;
+	d.nack = sim_total.nack - sim_last.nack;
+	d.bad = sim_total.bad - sim_last.bad;
+	sim_last = sim_total;
+
+	printf("SIM %s: %lu round trips (%lu out, %lu in), modeled %.3f s = USB %.3f s + bus %.3f s + delays %.3f s\n",
+		op, d.out + d.in, d.out, d.in, (d.usb + d.bus + d.delay) / 1e9,
+		d.usb / 1e9, d.bus / 1e9, d.delay / 1e9);
+	if (d.nack)
+		printf("SIM %s: %lu bytes not acknowledged\n", op, d.nack);
+	if (d.bad)
+		printf("SIM %s: %lu malformed stream commands\n", op, d.bad);
+}
+/* End of [sim.c] package */
@@ -0,0 +1,71 @@
+/*
+ * sim.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Modeled cost of one blocking bulk transfer and of one byte on the wire */
+#define SIM_USB_RTT_NS		1000000ULL	/* one full speed frame */
+#define SIM_USB_BYTE_NS		800ULL		/* ~1.2 MB/s bulk payload */
+
+extern int sim_enable;
+extern char *sim_image;
+extern char *sim_chip;		/* SPI NAND model, NULL - default */
+
+/* Modeled time, nsec */
+extern unsigned long long sim_now;
+
+/* Replaces ch341a_spi_init()/ch341a_spi_shutdown() */
+int sim_attach(void);
+void sim_detach(void);
+
+/* libusb_bulk_transfer() replacement: returns the transferred length */
+int sim_bulk_transfer(uint8_t ep, uint8_t *buf, int len);
+
+/* Print round trips and modeled time since the previous report */
+void sim_report(const char *op);
+
+/* Host side wait, modeled time moves on with the chip busy */
+void sim_sleep(unsigned long long ns);
+
+/* Device model behind the CH341A I2C, SPI stream and UIO (bit-bang) engines */
+struct sim_dev {
+	const char *name;
+	uint8_t *(*attach)(uint32_t *size);	/* returns the memory array */
+	/* Sparse models keep their own storage and image format instead */
+	int (*open)(FILE *image, uint64_t *size);	/* image is NULL for a blank chip */
+	void (*close)(FILE *image);			/* image is NULL without --sim=<file> */
+	void (*i2c_start)(void);
+	void (*i2c_stop)(void);
+	int (*i2c_write)(uint8_t b);		/* 1 - ACK */
+	uint8_t (*i2c_read)(void);
+	void (*uio_pins)(uint8_t pins);		/* D0-D5 output state */
+	int (*uio_in)(void);			/* D7 input */
+	void (*spi_cs)(int active);		/* D0 driven low */
+	uint8_t (*spi_xfer)(uint8_t mosi);	/* MSB first, returns MISO */
+};
+
+extern struct sim_dev sim_24cxx;
+extern struct sim_dev sim_93cxx;
+extern struct sim_dev sim_snand;
+
+/* A 24Cxx on the I2C pins next to the SPI chip, it starts blank and is not kept */
+struct EEPROM;
+void sim_24cxx_select(const struct EEPROM *info);
+int sim_attach_i2c(struct sim_dev *dev);
+
+#endif /* __SIM_H__ */
+/* End of [sim.h] package */
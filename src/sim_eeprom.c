@@ -0,0 +1,384 @@
+/*
+ * sim_eeprom.c
+ *
+ * Device models for the simulator: 24Cxx I2C EEPROM behind the CH341A I2C
+ * stream and 93Cxx Microwire EEPROM behind the UIO bit-bang pins.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "ch341a_i2c.h"
+#include "bitbang_microwire.h"
+
+extern struct EEPROM eeprom_info;
+
+/* ------------------------------------------------------------------------- */
+/* 24Cxx */
+
+#define E24_IDLE	0
+#define E24_DEVICE	1	/* expect device address */
+#define E24_WORD	2	/* word address bytes */
+#define E24_WRITE	3	/* data into the page buffer */
+#define E24_READ	4
+#define E24_IGNORE	5	/* not addressed or busy, wait for START */
+
+#define E24_MAX_PAGE	256
+
+/* Chip of the companion EEPROM, NULL - the one given with -E */
+static const struct EEPROM *e24_sel;
+
+static struct {
+	const struct EEPROM *info;
+	uint8_t *mem;
+	uint32_t size, page;
+	unsigned long long twr, busy;	/* nsec */
+	int state, word;
+	uint32_t ptr, base;
+	uint8_t buf[E24_MAX_PAGE];
+	uint8_t load[E24_MAX_PAGE];
+	int loaded;
+} e24;
+
+static uint8_t *e24_attach(uint32_t *size)
+{
+	memset(&e24, 0, sizeof(e24));
+	e24.info = e24_sel ? e24_sel : &eeprom_info;
+	e24.size = e24.info->size;
+	e24.page = e24.info->page_size;
+	e24.twr = e24.info->twr_typ * 1000ULL;
+
+	if (!(e24.mem = malloc(e24.size))) {
+		printf("Malloc failed for simulated EEPROM.\n");
+		return NULL;
+	}
+	memset(e24.mem, 0xff, e24.size);
+	printf("Simulated EEPROM: %s, page %u bytes, tWR %u us\n", e24.info->name, e24.page, e24.info->twr_typ);
+
+	*size = e24.size;
+	return e24.mem;
+}
+
+static void e24_start(void)
+{
+	/* Repeated START drops a pending page write */
+	e24.loaded = 0;
+	e24.state = E24_DEVICE;
+}
+
+static void e24_stop(void)
+{
+	uint32_t i;
+
+	if (e24.state == E24_WRITE && e24.loaded) {
+		for (i = 0; i < e24.page; i++)
+			if (e24.load[i])
+				e24.mem[e24.base + i] = e24.buf[i];
+		e24.busy = sim_now + e24.twr;
+	}
+	e24.loaded = 0;
+	e24.state = E24_IDLE;
+}
+
+static int e24_write(uint8_t b)
+{
+	uint32_t col, block = (b >> 1) & 0x07;
+
+	switch (e24.state) {
+	case E24_DEVICE:
+		/* Unused A2..A0 pins are tied low, the rest select a block */
+		if ((b & 0xF0) != 0xA0 || (block & ~e24.info->i2c_addr_mask) || sim_now < e24.busy) {
+			e24.state = E24_IGNORE;
+			return 0;
+		}
+		if (b & 1) {
+			e24.state = E24_READ;
+		} else {
+			e24.ptr = block << (8 * e24.info->addr_size);
+			e24.word = 0;
+			e24.state = E24_WORD;
+		}
+		return 1;
+	case E24_WORD:
+		e24.ptr |= (uint32_t)b << (8 * (e24.info->addr_size - 1 - e24.word));
+		if (++e24.word == e24.info->addr_size) {
+			e24.ptr %= e24.size;
+			e24.base = e24.ptr & ~(e24.page - 1);
+			memset(e24.load, 0, sizeof(e24.load));
+			e24.state = E24_WRITE;
+		}
+		return 1;
+	case E24_WRITE:
+		/* Column address wraps within the page */
+		col = e24.ptr & (e24.page - 1);
+		e24.buf[col] = b;
+		e24.load[col] = 1;
+		e24.loaded = 1;
+		e24.ptr = e24.base | ((col + 1) & (e24.page - 1));
+		return 1;
+	}
+
+	return 0;
+}
+
+static uint8_t e24_read(void)
+{
+	uint8_t b;
+
+	if (e24.state != E24_READ)
+		return 0xff;
+
+	b = e24.mem[e24.ptr];
+	e24.ptr = (e24.ptr + 1) % e24.size;
+	return b;
+}
+
+struct sim_dev sim_24cxx = {
+	.name		= "24Cxx I2C EEPROM",
+	.attach		= e24_attach,
+	.i2c_start	= e24_start,
+	.i2c_stop	= e24_stop,
+	.i2c_write	= e24_write,
+	.i2c_read	= e24_read,
+};
+
+void sim_24cxx_select(const struct EEPROM *info)
+{
+	e24_sel = info;
+}
+
+/* ------------------------------------------------------------------------- */
+/* 93Cxx */
+
+#define MW_PIN_CS	0x01
+#define MW_PIN_CLK	0x08
+#define MW_PIN_DI	0x20
+
+#define MW_IDLE		0	/* wait for start bit */
+#define MW_COMMAND	1	/* opcode and address */
+#define MW_DATA		2	/* WRITE/WRAL data */
+#define MW_READ		3
+#define MW_DONE		4	/* wait for CS low */
+
+#define MW_OP_EXT	0	/* EWEN/EWDS/ERAL/WRAL by address MSBs */
+#define MW_OP_WRITE	1
+#define MW_OP_READ	2
+#define MW_OP_ERASE	3
+
+#define MW_EXT_EWDS	0
+#define MW_EXT_WRAL	1
+#define MW_EXT_ERAL	2
+#define MW_EXT_EWEN	3
+
+static struct {
+	uint8_t *mem;
+	uint32_t size, words;
+	int org16, abits, wbits;
+	unsigned long long twc, tec, busy;	/* nsec */
+	int cs, clk, state, n;
+	uint32_t shift, addr, word;
+	int op, ext, pending, ewen, status, dout;
+} mw;
+
+/* Address length of the real parts, see addr_nbits() in bitbang_microwire.c */
+static int mw_addr_bits(uint32_t size, int org16)
+{
+	switch (size) {
+	case 128:
+		return org16 ? 6 : 7;
+	case 256:
+	case 512:
+		return org16 ? 8 : 9;
+	case 1024:
+	case 2048:
+		return org16 ? 10 : 11;
+	case 4096:
+		return org16 ? 12 : 13;
+	}
+	return 6;
+}
+
+static uint8_t *mw_attach(uint32_t *size)
+{
+	int i;
+
+	memset(&mw, 0, sizeof(mw));
+	mw.size = mw_eepromsize;
+	mw.org16 = org;
+	mw.wbits = org ? 16 : 8;
+	mw.words = mw.size / (org ? 2 : 1);
+	mw.abits = mw_addr_bits(mw.size, org);
+	for (i = 0; mw_eepromlist[i].size; i++) {
+		if (mw_eepromlist[i].size == mw.size) {
+			mw.twc = mw_eepromlist[i].twc_typ * 1000ULL;
+			mw.tec = mw_eepromlist[i].tec_max * 1000ULL;
+		}
+	}
+
+	if (!(mw.mem = malloc(mw.size))) {
+		printf("Malloc failed for simulated EEPROM.\n");
+		return NULL;
+	}
+	memset(mw.mem, 0xff, mw.size);
+	printf("Simulated EEPROM: 93Cxx, org %d bits, address %d bits, tWC %llu us\n",
+		mw.wbits, mw.abits, mw.twc / 1000);
+
+	*size = mw.size;
+	return mw.mem;
+}
+
+static uint32_t mw_get(uint32_t a)
+{
+	if (mw.org16)
+		return mw.mem[2 * a] << 8 | mw.mem[2 * a + 1];
+	return mw.mem[a];
+}
+
+static void mw_put(uint32_t a, uint32_t w)
+{
+	if (mw.org16) {
+		mw.mem[2 * a] = w >> 8;
+		mw.mem[2 * a + 1] = w;
+	} else
+		mw.mem[a] = w;
+}
+
+/* Opcode and address are in, decide what follows */
+static void mw_command(void)
+{
+	mw.op = mw.shift >> mw.abits;
+	mw.addr = (mw.shift & ((1 << mw.abits) - 1)) % mw.words;
+	mw.ext = mw.shift >> (mw.abits - 2) & 0x03;
+	mw.n = 0;
+	mw.shift = 0;
+	mw.state = MW_DONE;
+
+	switch (mw.op) {
+	case MW_OP_READ:
+		/* Dummy 0 first, data MSB on the next rising edge */
+		mw.word = mw_get(mw.addr);
+		mw.n = -1;
+		mw.dout = 0;
+		mw.state = MW_READ;
+		break;
+	case MW_OP_WRITE:
+		mw.state = MW_DATA;
+		break;
+	case MW_OP_ERASE:
+		mw.pending = 1;
+		break;
+	case MW_OP_EXT:
+		if (mw.ext == MW_EXT_EWEN)
+			mw.ewen = 1;
+		else if (mw.ext == MW_EXT_EWDS)
+			mw.ewen = 0;
+		else if (mw.ext == MW_EXT_ERAL)
+			mw.pending = 1;
+		else
+			mw.state = MW_DATA;
+		break;
+	}
+}
+
+static void mw_clock(int di)
+{
+	switch (mw.state) {
+	case MW_IDLE:
+		if (di) {
+			mw.state = MW_COMMAND;
+			mw.status = 0;
+			mw.n = 0;
+			mw.shift = 0;
+		}
+		break;
+	case MW_COMMAND:
+		mw.shift = mw.shift << 1 | di;
+		if (++mw.n == 2 + mw.abits)
+			mw_command();
+		break;
+	case MW_DATA:
+		mw.shift = mw.shift << 1 | di;
+		if (++mw.n == mw.wbits) {
+			mw.word = mw.shift;
+			mw.pending = 1;
+			mw.state = MW_DONE;
+		}
+		break;
+	case MW_READ:
+		/* Sequential read continues into the next word */
+		if (++mw.n == mw.wbits) {
+			mw.n = 0;
+			mw.addr = (mw.addr + 1) % mw.words;
+			mw.word = mw_get(mw.addr);
+		}
+		mw.dout = (mw.word >> (mw.wbits - 1 - mw.n)) & 1;
+		break;
+	}
+}
+
+/* CS low starts the self timed cycle of a complete erase/write command */
+static void mw_execute(void)
+{
+	uint32_t a;
+
+	if (mw.pending && mw.ewen) {
+		if (mw.op == MW_OP_EXT) {
+			for (a = 0; a < mw.words; a++)
+				mw_put(a, mw.ext == MW_EXT_WRAL ? mw.word : 0xffff);
+			mw.busy = sim_now + mw.tec;
+		} else {
+			mw_put(mw.addr, mw.op == MW_OP_WRITE ? mw.word : 0xffff);
+			mw.busy = sim_now + mw.twc;
+		}
+		mw.status = 1;
+	}
+	mw.pending = 0;
+	mw.state = MW_IDLE;
+}
+
+static void mw_pins(uint8_t pins)
+{
+	int cs = !!(pins & MW_PIN_CS), clk = !!(pins & MW_PIN_CLK);
+
+	if (cs && !mw.cs)
+		mw.state = MW_IDLE;
+	if (!cs && mw.cs)
+		mw_execute();
+	if (cs && clk && !mw.clk)
+		mw_clock(!!(pins & MW_PIN_DI));
+
+	mw.cs = cs;
+	mw.clk = clk;
+}
+
+static int mw_do(void)
+{
+	if (!mw.cs)
+		return 1;
+	if (mw.state == MW_READ)
+		return mw.dout;
+	/* Ready/busy status after an erase/write cycle was started */
+	if (mw.state == MW_IDLE && mw.status)
+		return sim_now >= mw.busy;
+	return 1;
+}
+
+struct sim_dev sim_93cxx = {
+	.name		= "93Cxx Microwire EEPROM",
+	.attach		= mw_attach,
+	.uio_pins	= mw_pins,
+	.uio_in		= mw_do,
+};
+/* End of [sim_eeprom.c] package */
@@ -0,0 +1,371 @@
+/*
+ * sim_nand.c
+ *
+ * SPI NAND model for the simulator: the command set the driver uses (read
+ * ID, get/set feature, page read, read from cache, program load, program
+ * execute, block erase) with tR/tPROG/tBERS busy time on the modeled clock.
+ * Blocks get memory on the first program, so the 8 and 16 Gbit parts only
+ * cost what a test writes.
+ *
+ * Image file: records of a 32-bit little endian block number followed by
+ * the raw block, every page with its spare area. Blank blocks are left out.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+
+#define SN_OP_GET_FEATURE	0x0F
+#define SN_OP_SET_FEATURE	0x1F
+#define SN_OP_PAGE_READ		0x13
+#define SN_OP_READ_CACHE	0x03
+#define SN_OP_READ_CACHE_FAST	0x0B
+#define SN_OP_READ_CACHE_DUAL	0x3B
+#define SN_OP_READ_CACHE_QUAD	0x6B
+#define SN_OP_WRITE_ENABLE	0x06
+#define SN_OP_WRITE_DISABLE	0x04
+#define SN_OP_PROGRAM_LOAD	0x02
+#define SN_OP_PROGRAM_LOAD_QUAD	0x32
+#define SN_OP_PROGRAM_RANDOM	0x84
+#define SN_OP_PROGRAM_RANDOM_QUAD	0x34
+#define SN_OP_PROGRAM_EXECUTE	0x10
+#define SN_OP_READ_ID		0x9F
+#define SN_OP_BLOCK_ERASE	0xD8
+#define SN_OP_RESET		0xFF
+
+#define SN_REG_STATUS		0xC0
+#define SN_STATUS_OIP		0x01
+#define SN_STATUS_WEL		0x02
+#define SN_STATUS_E_FAIL	0x04
+#define SN_STATUS_P_FAIL	0x08
+
+/* Datasheet typical values, the driver's generic timing */
+#define SN_T_READ_NS		60000ULL
+#define SN_T_PROG_NS		400000ULL
+#define SN_T_ERASE_NS		3000000ULL
+
+struct sn_part {
+	const char *key;		/* --sim-chip=<key> */
+	const char *name;
+	uint8_t id[3];			/* after the 9Fh dummy byte */
+	uint32_t page, oob, pages, blocks;
+	int cache_lost;			/* cache reads 0xFF after PROGRAM EXECUTE */
+};
+
+static const struct sn_part sn_parts[] = {
+	{ "w25n01g", "WINBOND W25N01G", { 0xEF, 0xAA, 0x21 }, 2048,  64, 64, 1024 },
+	{ "8gbit",   "SIM NAND 8GBIT",  { 0x53, 0x48, 0x00 }, 4096, 256, 64, 4096, 1 },
+	{ "16gbit",  "SIM NAND 16GBIT", { 0x53, 0x58, 0x00 }, 4096, 256, 64, 8192 },
+	{ 0 }
+};
+
+static struct {
+	const struct sn_part *part;
+	uint32_t raw;			/* page with spare area */
+	uint32_t block_bytes;
+	uint8_t **blk;			/* NULL - erased */
+	uint8_t *cache;
+	uint8_t reg[256];
+	int wel, fail;
+	unsigned long long busy;	/* sim_now when the array is ready */
+	int pos;			/* bytes since CS went low */
+	uint8_t op, arg[3];
+	uint32_t col;
+	unsigned long ignored;		/* commands while busy or not write enabled */
+} sn;
+
+static const struct sn_part *sn_find(const char *name)
+{
+	const struct sn_part *p;
+
+	if (!name)
+		return &sn_parts[0];
+	for (p = sn_parts; p->key; p++)
+		if (!strcmp(p->key, name))
+			return p;
+	return NULL;
+}
+
+static uint8_t *sn_page(uint32_t row, int alloc)
+{
+	uint32_t block = row / sn.part->pages;
+	uint8_t *b = sn.blk[block];
+
+	if (!b && alloc) {
+		if (!(b = malloc(sn.block_bytes)))
+			return NULL;
+		memset(b, 0xff, sn.block_bytes);
+		sn.blk[block] = b;
+	}
+	return b ? b + (row % sn.part->pages) * sn.raw : NULL;
+}
+
+static uint32_t sn_row(void)
+{
+	uint32_t row = sn.arg[0] << 16 | sn.arg[1] << 8 | sn.arg[2];
+
+	return row % (sn.part->pages * sn.part->blocks);
+}
+
+static int sn_busy(void)
+{
+	return sim_now < sn.busy;
+}
+
+static uint8_t sn_status(void)
+{
+	return (sn_busy() ? SN_STATUS_OIP : 0) | (sn.wel ? SN_STATUS_WEL : 0) | sn.fail;
+}
+
+static void sn_reset(void)
+{
+	memset(sn.reg, 0, sizeof(sn.reg));
+	sn.reg[0xB0] = 0x10;		/* on-die ECC enabled */
+	sn.wel = 0;
+	sn.fail = 0;
+}
+
+/* Commands that run when CS goes high */
+static void sn_execute(void)
+{
+	uint8_t *p;
+	uint32_t i;
+
+	if (sn.pos < 4)
+		return;
+
+	switch (sn.op) {
+	case SN_OP_PAGE_READ:
+		if ((p = sn_page(sn_row(), 0)))
+			memcpy(sn.cache, p, sn.raw);
+		else
+			memset(sn.cache, 0xff, sn.raw);
+		sn.busy = sim_now + SN_T_READ_NS;
+		break;
+	case SN_OP_PROGRAM_EXECUTE:
+		if (!sn.wel) {
+			sn.ignored++;
+			break;
+		}
+		sn.fail &= ~SN_STATUS_P_FAIL;
+		/* Program only clears bits */
+		if (!(p = sn_page(sn_row(), 1))) {
+			sn.fail |= SN_STATUS_P_FAIL;
+		} else {
+			for (i = 0; i < sn.raw; i++)
+				p[i] &= sn.cache[i];
+		}
+		if (sn.part->cache_lost)
+			memset(sn.cache, 0xff, sn.raw);
+		sn.wel = 0;
+		sn.busy = sim_now + SN_T_PROG_NS;
+		break;
+	case SN_OP_BLOCK_ERASE:
+		if (!sn.wel) {
+			sn.ignored++;
+			break;
+		}
+		i = sn_row() / sn.part->pages;
+		free(sn.blk[i]);
+		sn.blk[i] = NULL;
+		sn.fail &= ~SN_STATUS_E_FAIL;
+		sn.wel = 0;
+		sn.busy = sim_now + SN_T_ERASE_NS;
+		break;
+	}
+}
+
+static void sn_cs(int active)
+{
+	if (!active)
+		sn_execute();
+	sn.pos = 0;
+}
+
+static uint8_t sn_xfer(uint8_t b)
+{
+	int pos = sn.pos++;
+	uint8_t out = 0xff;
+
+	if (!pos) {
+		sn.op = b;
+		/* Only status reads and reset are accepted while busy */
+		if (sn_busy() && b != SN_OP_GET_FEATURE && b != SN_OP_RESET) {
+			sn.ignored++;
+			sn.op = 0;
+			return out;
+		}
+		switch (b) {
+		case SN_OP_WRITE_ENABLE:
+			sn.wel = 1;
+			break;
+		case SN_OP_WRITE_DISABLE:
+			sn.wel = 0;
+			break;
+		case SN_OP_RESET:
+			sn_reset();
+			break;
+		case SN_OP_PROGRAM_LOAD:
+		case SN_OP_PROGRAM_LOAD_QUAD:
+			memset(sn.cache, 0xff, sn.raw);
+			break;
+		}
+		return out;
+	}
+
+	switch (sn.op) {
+	case SN_OP_READ_ID:
+		if (pos >= 2 && pos <= 4)
+			out = sn.part->id[pos - 2];
+		break;
+	case SN_OP_GET_FEATURE:
+		if (pos == 1)
+			sn.arg[0] = b;
+		else
+			out = sn.arg[0] == SN_REG_STATUS ? sn_status() : sn.reg[sn.arg[0]];
+		break;
+	case SN_OP_SET_FEATURE:
+		if (pos == 1)
+			sn.arg[0] = b;
+		else if (pos == 2 && sn.arg[0] != SN_REG_STATUS)
+			sn.reg[sn.arg[0]] = b;
+		break;
+	case SN_OP_PAGE_READ:
+	case SN_OP_PROGRAM_EXECUTE:
+	case SN_OP_BLOCK_ERASE:
+		if (pos <= 3)
+			sn.arg[pos - 1] = b;
+		break;
+	case SN_OP_READ_CACHE:
+	case SN_OP_READ_CACHE_FAST:
+	case SN_OP_READ_CACHE_DUAL:
+	case SN_OP_READ_CACHE_QUAD:
+		/* Column address, then one dummy byte */
+		if (pos == 1)
+			sn.col = (b & 0x1F) << 8;
+		else if (pos == 2)
+			sn.col |= b;
+		else if (pos >= 4)
+			out = sn.col < sn.raw ? sn.cache[sn.col++] : 0xff;
+		break;
+	case SN_OP_PROGRAM_LOAD:
+	case SN_OP_PROGRAM_LOAD_QUAD:
+	case SN_OP_PROGRAM_RANDOM:
+	case SN_OP_PROGRAM_RANDOM_QUAD:
+		if (pos == 1)
+			sn.col = (b & 0x1F) << 8;
+		else if (pos == 2)
+			sn.col |= b;
+		else if (sn.col < sn.raw)
+			sn.cache[sn.col++] = b;
+		break;
+	}
+	return out;
+}
+
+static void sn_free(void)
+{
+	uint32_t i;
+
+	if (sn.blk)
+		for (i = 0; i < sn.part->blocks; i++)
+			free(sn.blk[i]);
+	free(sn.blk);
+	free(sn.cache);
+	sn.blk = NULL;
+	sn.cache = NULL;
+}
+
+static int sn_load(FILE *fp)
+{
+	unsigned char hdr[4];
+	uint32_t block, n = 0;
+
+	while (fread(hdr, 1, sizeof(hdr), fp) == sizeof(hdr)) {
+		block = hdr[0] | hdr[1] << 8 | hdr[2] << 16 | (uint32_t)hdr[3] << 24;
+		if (block >= sn.part->blocks || sn.blk[block] ||
+		    !(sn.blk[block] = malloc(sn.block_bytes)) ||
+		    fread(sn.blk[block], 1, sn.block_bytes, fp) != sn.block_bytes) {
+			printf("Simulator image %s is not a %s image.\n", sim_image, sn.part->name);
+			return -1;
+		}
+		n++;
+	}
+	printf("Simulator image %s: %u of %u blocks programmed\n", sim_image, n, sn.part->blocks);
+	return 0;
+}
+
+static int sn_open(FILE *image, uint64_t *size)
+{
+	memset(&sn, 0, sizeof(sn));
+	if (!(sn.part = sn_find(sim_chip))) {
+		printf("Unknown simulated SPI NAND %s, models:", sim_chip);
+		for (sn.part = sn_parts; sn.part->key; sn.part++)
+			printf(" %s", sn.part->key);
+		printf("\n");
+		return -1;
+	}
+	sn.raw = sn.part->page + sn.part->oob;
+	sn.block_bytes = sn.raw * sn.part->pages;
+	sn.blk = calloc(sn.part->blocks, sizeof(*sn.blk));
+	sn.cache = malloc(sn.raw);
+	if (!sn.blk || !sn.cache) {
+		printf("Malloc failed for simulated SPI NAND.\n");
+		sn_free();
+		return -1;
+	}
+	sn_reset();
+	sim_snand.name = sn.part->name;
+
+	if (image && sn_load(image) < 0) {
+		sn_free();
+		return -1;
+	}
+	*size = (uint64_t)sn.part->page * sn.part->pages * sn.part->blocks;
+	return 0;
+}
+
+static void sn_close(FILE *image)
+{
+	unsigned char hdr[4];
+	uint32_t i, j;
+
+	for (i = 0; image && i < sn.part->blocks; i++) {
+		if (!sn.blk[i])
+			continue;
+		for (j = 0; j < sn.block_bytes && sn.blk[i][j] == 0xff; j++)
+			;
+		if (j == sn.block_bytes)
+			continue;
+		hdr[0] = i;
+		hdr[1] = i >> 8;
+		hdr[2] = i >> 16;
+		hdr[3] = i >> 24;
+		fwrite(hdr, 1, sizeof(hdr), image);
+		fwrite(sn.blk[i], 1, sn.block_bytes, image);
+	}
+	if (sn.ignored)
+		printf("SIM: %lu SPI NAND commands ignored (busy or not write enabled)\n", sn.ignored);
+	sn_free();
+}
+
+struct sim_dev sim_snand = {
+	.name     = "SPI NAND",
+	.open     = sn_open,
+	.close    = sn_close,
+	.spi_cs   = sn_cs,
+	.spi_xfer = sn_xfer,
+};
+/* End of [sim_nand.c] package */
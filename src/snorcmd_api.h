@@ -15,10 +15,13 @@
 #ifndef __SNORCMD_API_H__
 #define __SNORCMD_API_H__
 
-int snor_read(unsigned char *buf, unsigned long from, unsigned long len);
-int snor_erase(unsigned long offs, unsigned long len);
-int snor_write(unsigned char *buf, unsigned long to, unsigned long len);
-long snor_init(void);
+struct flash_info;
+
+long long snor_read(unsigned char *buf, unsigned long long from, unsigned long long len);
+int snor_erase(unsigned long long offs, unsigned long long len);
+long long snor_write(unsigned char *buf, unsigned long long to, unsigned long long len);
+long long snor_init(void);
+void snor_info(struct flash_info *info);
 void support_snor_list(void);
 
 #endif /* __SNORCMD_API_H__ */
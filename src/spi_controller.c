@@ -51,6 +51,26 @@ SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Write_NByte( u8 *ptr_data, u32 len, SPI_CONT
 	return (SPI_CONTROLLER_RTN_T)ch341a_spi_send_command(len, 0, ptr_data, NULL);
 }
 
+int SPI_CONTROLLER_Submit_Xfer( u8 *ptr_data_out, u32 len_out, u8 *ptr_data_in, u32 len_in )
+{
+	return ch341a_spi_submit(len_out, len_in, ptr_data_out, ptr_data_in);
+}
+
+int SPI_CONTROLLER_Poll_Xfer( int handle )
+{
+	return ch341a_spi_poll(handle);
+}
+
+SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Wait_Xfer( int handle )
+{
+	return (SPI_CONTROLLER_RTN_T)ch341a_spi_wait(handle);
+}
+
+SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Wait_All( void )
+{
+	return (SPI_CONTROLLER_RTN_T)ch341a_spi_flush();
+}
+
 #if 0
 SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Xfer_NByte( u8 *ptr_data_in, u32 len_in, u8 *ptr_data_out, u32 len_out, SPI_CONTROLLER_SPEED_T speed )
 {
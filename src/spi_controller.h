@@ -167,6 +167,86 @@ SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Chip_Select_Low( void );
  */
 SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Chip_Select_High( void );
 
+/*------------------------------------------------------------------------------------
+ * FUNCTION: int SPI_CONTROLLER_Submit_Xfer( u8    *ptr_data_out,
+ *                                           u32   len_out,
+ *                                           u8    *ptr_data_in,
+ *                                           u32   len_in        )
+ * PURPOSE : To queue one transaction (chip select low, write len_out bytes, read
+ *           len_in bytes, chip select high) without waiting for it.
+ * AUTHOR  :
+ * CALLED BY
+ *   -
+ * CALLS
+ *   -
+ * PARAMs  :
+ *   INPUT : ptr_data_out - The data to write, copied before return.
+ *           len_out      - The number of bytes to write.
+ *           len_in       - The number of bytes to read after the write.
+ *   OUTPUT: ptr_data_in  - Filled when the transaction completes.
+ * RETURN  : Handle of the transaction (>= 0).   -1 - Failed.
+ * NOTES   : At most CH341A_ASYNC_DEPTH transactions are on the wire, a submit
+ *           beyond that waits for the oldest one. Transactions and blocking calls
+ *           reach the chip in call order.
+ * MODIFICTION HISTORY:
+ *------------------------------------------------------------------------------------
+ */
+int SPI_CONTROLLER_Submit_Xfer( u8 *ptr_data_out, u32 len_out, u8 *ptr_data_in, u32 len_in );
+
+/*------------------------------------------------------------------------------------
+ * FUNCTION: int SPI_CONTROLLER_Poll_Xfer( int handle )
+ * PURPOSE : To check a queued transaction without blocking.
+ * AUTHOR  :
+ * CALLED BY
+ *   -
+ * CALLS
+ *   -
+ * PARAMs  :
+ *   INPUT : handle - The handle from SPI_CONTROLLER_Submit_Xfer.
+ *   OUTPUT: None
+ * RETURN  : 1 - Done.   0 - In progress.   -1 - Failed.
+ * NOTES   :
+ * MODIFICTION HISTORY:
+ *------------------------------------------------------------------------------------
+ */
+int SPI_CONTROLLER_Poll_Xfer( int handle );
+
+/*------------------------------------------------------------------------------------
+ * FUNCTION: SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Wait_Xfer( int handle )
+ * PURPOSE : To wait for a queued transaction and every one queued before it.
+ * AUTHOR  :
+ * CALLED BY
+ *   -
+ * CALLS
+ *   -
+ * PARAMs  :
+ *   INPUT : handle - The handle from SPI_CONTROLLER_Submit_Xfer.
+ *   OUTPUT: None
+ * RETURN  : SPI_RTN_NO_ERROR - Successful.   Otherwise - Failed.
+ * NOTES   :
+ * MODIFICTION HISTORY:
+ *------------------------------------------------------------------------------------
+ */
+SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Wait_Xfer( int handle );
+
+/*------------------------------------------------------------------------------------
+ * FUNCTION: SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Wait_All( void )
+ * PURPOSE : To wait for all queued transactions.
+ * AUTHOR  :
+ * CALLED BY
+ *   -
+ * CALLS
+ *   -
+ * PARAMs  :
+ *   INPUT : None
+ *   OUTPUT: None
+ * RETURN  : SPI_RTN_NO_ERROR - All of them completed since the last call.   Otherwise - Failed.
+ * NOTES   :
+ * MODIFICTION HISTORY:
+ *------------------------------------------------------------------------------------
+ */
+SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Wait_All( void );
+
 #if 0
 SPI_CONTROLLER_RTN_T SPI_CONTROLLER_Xfer_NByte( u8 *ptr_data_in, u32 len_in, u8 *ptr_data_out, u32 len_out, SPI_CONTROLLER_SPEED_T speed );
 #endif
@@ -33,11 +33,17 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <ctype.h>
+#include <strings.h>
 #include "types.h"
 #include "spi_nand_flash.h"
 #include "spi_controller.h"
-#include "nandcmd_api.h"
+#include "flashcmd_api.h"
 #include "timer.h"
+#include "flash_stat.h"
+#include "spi_speed.h"
+#include "sim.h"
+#include "profile.h"
 
 /* NAMING CONSTANT DECLARATIONS ------------------------------------------------------ */
 
@@ -92,6 +98,8 @@
 #define _SPI_NAND_CHIP_SIZE_1GBIT			0x08000000
 #define _SPI_NAND_CHIP_SIZE_2GBIT			0x10000000
 #define _SPI_NAND_CHIP_SIZE_4GBIT			0x20000000
+#define _SPI_NAND_CHIP_SIZE_8GBIT			0x40000000
+#define _SPI_NAND_CHIP_SIZE_16GBIT			0x80000000ULL
 
 /* SPI NAND Manufacturers ID */
 #define _SPI_NAND_MANUFACTURER_ID_GIGADEVICE		0xC8
@@ -114,6 +122,7 @@
 #define _SPI_NAND_MANUFACTURER_ID_DS			0xE5
 #define _SPI_NAND_MANUFACTURER_ID_FISON			0x6B
 #define _SPI_NAND_MANUFACTURER_ID_TYM			0x19
+#define _SPI_NAND_MANUFACTURER_ID_SIM			0x53
 
 /* SPI NAND Device ID */
 #define _SPI_NAND_DEVICE_ID_GD5F1GQ4UAYIG	0xF1
@@ -202,12 +211,18 @@
 #define _SPI_NAND_DEVICE_ID_TYM25D2GA01		0x01
 #define _SPI_NAND_DEVICE_ID_TYM25D2GA02		0x02
 #define _SPI_NAND_DEVICE_ID_TYM25D1GA03		0x03
+#define _SPI_NAND_DEVICE_ID_SIM_8GBIT		0x48
+#define _SPI_NAND_DEVICE_ID_SIM_16GBIT		0x58
 
 /* Others Define */
 #define _SPI_NAND_LEN_ONE_BYTE			(1)
 #define _SPI_NAND_LEN_TWO_BYTE			(2)
 #define _SPI_NAND_LEN_THREE_BYTE		(3)
 #define _SPI_NAND_BLOCK_ROW_ADDRESS_OFFSET	(6)
+#define _SPI_NAND_ECC_DIES_MAX			(8)	/* dies with a cached ECC enable register */
+#define _SPI_NAND_BBM_BYTES			(2)	/* bad block marker, first OOB bytes of the first page */
+#define _SPI_NAND_PATTERN_RELOAD		(64)	/* pattern rows per PROGRAM LOAD, the last one is read back */
+#define _SPI_NAND_CACHE_KEEP_KEY		"cache_keep"
 
 #define _SPI_NAND_OOB_SIZE			256
 #define _SPI_NAND_PAGE_SIZE			(4096 + _SPI_NAND_OOB_SIZE)
@@ -224,7 +239,7 @@
 /* FUNCTION DECLARATIONS ------------------------------------------------------ */
 
 /* MACRO DECLARATIONS ---------------------------------------------------------------- */
-#define _SPI_NAND_BLOCK_ALIGNED_CHECK( __addr__,__block_size__) ((__addr__) & ( __block_size__ - 1))
+#define _SPI_NAND_BLOCK_ALIGNED_CHECK( __addr__,__block_size__) ((__addr__) % (__block_size__))	/* -d blocks are not a power of two */
 #define _SPI_NAND_GET_DEVICE_INFO_PTR		&(_current_flash_info_t)
 
 /* Porting Replacement */
@@ -250,6 +265,8 @@ int ECC_ignore = 0;
 
 static unsigned char _plane_select_bit = 0;
 static unsigned char _die_id = 0;
+static u8 _ecc_feature_addr = _SPI_NAND_ADDR_FEATURE;	/* register with the ECC enable bit */
+static u8 _ecc_feature[_SPI_NAND_ECC_DIES_MAX];		/* its value per die as last written */
 int en_oob_write = 0;
 int en_oob_erase = 0;
 
@@ -263,7 +280,7 @@ unsigned char _ondie_ecc_flag = 1;    /* Ondie ECC : [ToDo :  Init this flag bas
 /* STATIC VARIABLE DECLARATIONS ------------------------------------------------------ */
 static unsigned long bmt_oob_size = 64;
 static u32 erase_oob_size = 0;
-static u32 ecc_size = 0;
+static u64 ecc_size = 0;
 u32 bsize = 0;
 #if 0
 static unsigned int print_dot = 0;
@@ -276,6 +293,7 @@ static u8 _current_cache_page_oob[_SPI_NAND_OOB_SIZE];
 static u8 _current_cache_page_oob_mapping[_SPI_NAND_OOB_SIZE];
 
 static struct SPI_NAND_FLASH_INFO_T _current_flash_info_t;	/* Store the current flash information */
+static struct busy_timing _nand_wait;				/* Delay before polling OIP after program/erase */
 
 
 struct spi_nand_flash_ooblayout ooblayout_esmt = {
@@ -479,6 +497,56 @@ struct spi_nand_flash_ooblayout ooblayout_tym = {
 	.oobfree = {{0,3}, {16,3}, {32,3}, {48,3}}
 };
 
+/* Datasheet tR (with on-die ECC), tPROG and tBERS, typical and max, usec */
+static const struct chip_timing timing_gigadevice = {
+	.read_typ = 50,   .read_max = 120,
+	.prog_typ = 400,  .prog_max = 700,
+	.erase_typ = 3000, .erase_max = 10000
+};
+
+static const struct chip_timing timing_esmt = {
+	.read_typ = 50,   .read_max = 100,
+	.prog_typ = 300,  .prog_max = 600,
+	.erase_typ = 2000, .erase_max = 10000
+};
+
+static const struct chip_timing timing_winbond = {
+	.read_typ = 50,   .read_max = 60,
+	.prog_typ = 250,  .prog_max = 700,
+	.erase_typ = 2000, .erase_max = 10000
+};
+
+static const struct chip_timing timing_mxic = {
+	.read_typ = 25,   .read_max = 45,
+	.prog_typ = 300,  .prog_max = 600,
+	.erase_typ = 1000, .erase_max = 4000
+};
+
+static const struct chip_timing timing_toshiba = {
+	.read_typ = 40,   .read_max = 115,
+	.prog_typ = 330,  .prog_max = 600,
+	.erase_typ = 2500, .erase_max = 7000
+};
+
+static const struct chip_timing timing_micron = {
+	.read_typ = 55,   .read_max = 115,
+	.prog_typ = 220,  .prog_max = 600,
+	.erase_typ = 2000, .erase_max = 10000
+};
+
+static const struct chip_timing timing_xtx = {
+	.read_typ = 50,   .read_max = 90,
+	.prog_typ = 300,  .prog_max = 600,
+	.erase_typ = 3000, .erase_max = 10000
+};
+
+/* Conservative values for parts without published typical timings */
+static const struct chip_timing timing_generic = {
+	.read_typ = 60,   .read_max = 120,
+	.prog_typ = 400,  .prog_max = 900,
+	.erase_typ = 3000, .erase_max = 10000
+};
+
 /*****************************[ Notice]******************************/
 /* If new spi nand chip have page size more than 4KB,  or oob size more than 256 bytes,  than*/
 /* it will need to adjust the #define of _SPI_NAND_PAGE_SIZE and _SPI_NAND_OOB_SIZE */
@@ -498,6 +566,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_a,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -513,6 +582,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -528,6 +598,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -543,6 +614,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_GD5FXGQ4U,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -558,6 +630,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -573,6 +646,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -588,6 +662,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -603,6 +678,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type2,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -618,6 +694,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -633,6 +710,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_gigadevice_256,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -648,6 +726,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout: 			&ooblayout_gigadevice_256,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_gigadevice,
 	},
 
 	{
@@ -663,6 +742,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_esmt,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_esmt,
 	},
 
 	{
@@ -678,6 +758,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_esmt,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_esmt,
 	},
 
 	{
@@ -693,6 +774,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_esmt_41lb,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_esmt,
 	},
 
 	{
@@ -708,6 +790,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_esmt_41lb,
 		feature:				SPI_NAND_FLASH_DIE_SELECT_1_HAVE,
+		timing:					&timing_esmt,
 	},
 
 	{
@@ -724,6 +807,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_winbond,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_winbond,
 	},
 
 	{
@@ -740,6 +824,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_winbond,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_winbond,
 	},
 
 	{
@@ -756,6 +841,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_winbond,
 		feature:				SPI_NAND_FLASH_DIE_SELECT_1_HAVE,
+		timing:					&timing_winbond,
 	},
 
 	{
@@ -771,6 +857,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_mxic,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_mxic,
 	},
 
 	{
@@ -786,6 +873,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_mxic,
 		feature:				SPI_NAND_FLASH_PLANE_SELECT_HAVE,
+		timing:					&timing_mxic,
 	},
 
 	{
@@ -802,6 +890,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_mxic,
 		feature:				SPI_NAND_FLASH_PLANE_SELECT_HAVE,
+		timing:					&timing_mxic,
 	},
 
 	{
@@ -817,6 +906,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_zentel,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -832,6 +922,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_zentel,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	/* Etron */
@@ -848,6 +939,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_etron_73C044SNB,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -863,6 +955,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -878,6 +971,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type10,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -893,6 +987,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -908,6 +1003,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -923,6 +1019,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type18,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -938,6 +1035,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -953,6 +1051,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type10,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -968,6 +1067,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -983,6 +1083,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -998,6 +1099,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_etron_73D044SNA,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1013,6 +1115,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_etron_73D044SNC,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1028,6 +1131,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1043,6 +1147,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type10,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1058,6 +1163,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_etron_73E044SNA,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1073,6 +1179,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout: 			&ooblayout_toshiba_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_toshiba,
 	},
 
 	{
@@ -1088,6 +1195,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout: 			&ooblayout_toshiba_128,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_toshiba,
 	},
 
 	{
@@ -1103,6 +1211,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout: 			&ooblayout_toshiba_256,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_toshiba,
 	},
 
 	{
@@ -1118,6 +1227,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout: 			&ooblayout_toshiba_256,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_toshiba,
 	},
 
 	{
@@ -1133,6 +1243,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_micron,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_micron,
 	},
 
 	{
@@ -1148,6 +1259,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_micron,
 		feature:				SPI_NAND_FLASH_PLANE_SELECT_HAVE,
+		timing:					&timing_micron,
 	},
 
 	{
@@ -1163,6 +1275,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_micron,
 		feature:				SPI_NAND_FLASH_PLANE_SELECT_HAVE | SPI_NAND_FLASH_DIE_SELECT_2_HAVE,
+		timing:					&timing_micron,
 	},
 
 	{
@@ -1178,6 +1291,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_heyang,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1193,6 +1307,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_heyang,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1208,6 +1323,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type14,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1223,6 +1339,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1238,6 +1355,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1253,6 +1371,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_pn,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1268,6 +1387,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_pn,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1283,6 +1403,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_pn,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1298,6 +1419,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_ato,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1313,6 +1435,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_ato_25D2GA,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1328,6 +1451,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_ato_25D2GB,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	/* FM */
@@ -1344,6 +1468,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fm,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1359,6 +1484,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fm_32,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1374,6 +1500,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fm,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1389,6 +1516,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fm,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1404,6 +1532,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fm_32,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1419,6 +1548,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	/* XTX */
@@ -1435,6 +1565,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_xtx,
 	},
 
 	{
@@ -1450,6 +1581,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type19,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_xtx,
 	},
 
 	{
@@ -1465,6 +1597,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type19,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_xtx,
 	},
 
 	/* Mira */
@@ -1481,6 +1614,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type6,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	/* BIWIN */
@@ -1497,6 +1631,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type15,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1512,6 +1647,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type10,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	/* FORESEE */
@@ -1528,6 +1664,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1543,6 +1680,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1558,6 +1696,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1573,6 +1712,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_type1,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1588,6 +1728,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_ds,
 		feature:				SPI_NAND_FLASH_PLANE_SELECT_HAVE,
+		timing:					&timing_generic,
 	},
 	{
 		mfr_id: 				_SPI_NAND_MANUFACTURER_ID_DS,
@@ -1602,6 +1743,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_ds,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1617,6 +1759,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fison,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 	{
 		mfr_id: 				_SPI_NAND_MANUFACTURER_ID_FISON,
@@ -1631,6 +1774,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fison,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 	{
 		mfr_id: 				_SPI_NAND_MANUFACTURER_ID_FISON,
@@ -1645,6 +1789,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_fison,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 
 	{
@@ -1660,6 +1805,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_tym,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 	{
 		mfr_id: 				_SPI_NAND_MANUFACTURER_ID_TYM,
@@ -1674,6 +1820,7 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_tym,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
 	},
 	{
 		mfr_id: 				_SPI_NAND_MANUFACTURER_ID_TYM,
@@ -1688,6 +1835,40 @@ static const struct SPI_NAND_FLASH_INFO_T spi_nand_flash_tables[] = {
 		write_mode: 				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
 		oob_free_layout:			&ooblayout_tym,
 		feature:				SPI_NAND_FLASH_FEATURE_NONE,
+		timing:					&timing_generic,
+	},
+
+	/* Simulator models (--sim), larger than any part above */
+	{
+		mfr_id:					_SPI_NAND_MANUFACTURER_ID_SIM,
+		dev_id:					_SPI_NAND_DEVICE_ID_SIM_8GBIT,
+		ptr_name:				"SIM NAND 8GBIT",
+		device_size:				_SPI_NAND_CHIP_SIZE_8GBIT,
+		page_size:				_SPI_NAND_PAGE_SIZE_4KBYTE,
+		oob_size:				_SPI_NAND_OOB_SIZE_256BYTE,
+		erase_size:				_SPI_NAND_BLOCK_SIZE_256KBYTE,
+		dummy_mode:				SPI_NAND_FLASH_READ_DUMMY_BYTE_APPEND,
+		read_mode:				SPI_NAND_FLASH_READ_SPEED_MODE_SINGLE,
+		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
+		oob_free_layout:			&ooblayout_gigadevice_256,
+		feature:				SPI_NAND_FLASH_SIM_ONLY,
+		timing:					&timing_generic,
+	},
+
+	{
+		mfr_id:					_SPI_NAND_MANUFACTURER_ID_SIM,
+		dev_id:					_SPI_NAND_DEVICE_ID_SIM_16GBIT,
+		ptr_name:				"SIM NAND 16GBIT",
+		device_size:				_SPI_NAND_CHIP_SIZE_16GBIT,
+		page_size:				_SPI_NAND_PAGE_SIZE_4KBYTE,
+		oob_size:				_SPI_NAND_OOB_SIZE_256BYTE,
+		erase_size:				_SPI_NAND_BLOCK_SIZE_256KBYTE,
+		dummy_mode:				SPI_NAND_FLASH_READ_DUMMY_BYTE_APPEND,
+		read_mode:				SPI_NAND_FLASH_READ_SPEED_MODE_SINGLE,
+		write_mode:				SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE,
+		oob_free_layout:			&ooblayout_gigadevice_256,
+		feature:				SPI_NAND_FLASH_SIM_ONLY,
+		timing:					&timing_generic,
 	},
 };
 
@@ -2394,14 +2575,14 @@ static SPI_NAND_FLASH_RTN_T spi_nand_protocol_read_from_cache( u32 data_offset,
  *
  *------------------------------------------------------------------------------------
  */
-static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_load ( u32 addr, u8 *ptr_data, u32 len, u32 write_mode)
+static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_load_op ( u8 opcode, u32 addr, u8 *ptr_data, u32 len, u32 write_mode)
 {
 	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 
 	ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
 
-	_SPI_NAND_DEBUG_PRINTF(SPI_NAND_FLASH_DEBUG_LEVEL_1, "spi_nand_protocol_program_load: addr = 0xl%x, len = 0x%x\n", addr, len );
+	_SPI_NAND_DEBUG_PRINTF(SPI_NAND_FLASH_DEBUG_LEVEL_1, "spi_nand_protocol_program_load: opcode = 0x%x, addr = 0xl%x, len = 0x%x\n", opcode, addr, len );
 
 	/* 1. Chip Select low */
 	_SPI_NAND_READ_CHIP_SELECT_LOW();
@@ -2423,7 +2604,7 @@ static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_load ( u32 addr, u8 *ptr_d
 			break;
 	}
 #else
-	_SPI_NAND_WRITE_ONE_BYTE( _SPI_NAND_OP_PROGRAM_LOAD_SINGLE );
+	_SPI_NAND_WRITE_ONE_BYTE( opcode );
 #endif
 	/* 3. Send address offset */
 	if( ((ptr_dev_info_t->feature) & SPI_NAND_FLASH_PLANE_SELECT_HAVE) )
@@ -2465,6 +2646,39 @@ static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_load ( u32 addr, u8 *ptr_d
 	return (rtn_status);
 }
 
+static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_load ( u32 addr, u8 *ptr_data, u32 len, u32 write_mode)
+{
+	return spi_nand_protocol_program_load_op( _SPI_NAND_OP_PROGRAM_LOAD_SINGLE, addr, ptr_data, len, write_mode );
+}
+
+/*------------------------------------------------------------------------------------
+ * FUNCTION: static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_load_random( u32     addr,
+ *                                                                              u8      *ptr_data,
+ *                                                                              u32     len,
+ *                                                                              u32 write_mode)
+ * PURPOSE : To implement the SPI nand protocol for program load random data (84h). Unlike
+ *           program load the rest of the cache is kept, so several loads make one page.
+ * AUTHOR  :
+ * CALLED BY
+ *   -
+ * CALLS
+ *   -
+ * PARAMs  :
+ *   INPUT : addr      - The column address in the cache.
+ *           ptr_data  - A pointer to the ptr_data variable.
+ *           len       - The len variable of this function.
+ *   OUTPUT: None
+ * RETURN  : SPI_RTN_NO_ERROR - Successful.   Otherwise - Failed.
+ * NOTES   :
+ * MODIFICTION HISTORY:
+ *
+ *------------------------------------------------------------------------------------
+ */
+static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_load_random ( u32 addr, u8 *ptr_data, u32 len, u32 write_mode)
+{
+	return spi_nand_protocol_program_load_op( _SPI_NAND_OP_PROGRAM_LOAD_RAMDOM_SINGLE, addr, ptr_data, len, write_mode );
+}
+
 /*------------------------------------------------------------------------------------
  * FUNCTION: static SPI_NAND_FLASH_RTN_T spi_nand_protocol_program_execute( u32  addr )
  * PURPOSE : To implement the SPI nand protocol for program execute.
@@ -2857,13 +3071,13 @@ static SPI_NAND_FLASH_RTN_T spi_nand_load_page_into_cache( u32 page_number)
 }
 
 /*------------------------------------------------------------------------------------
- * FUNCTION: spi_nand_set_clock_speed( u32 clock_factor)
+ * FUNCTION: spi_nand_set_clock_speed( u32 clk)
  * CALLED BY
  *   -
  * CALLS
  *   -
  * PARAMs  :
- *   INPUT : clock_factor - The SPI clock divider.
+ *   INPUT : clk - CH341A SPI clock setting, SPI_SPEED_MIN..SPI_SPEED_MAX.
  * RETURN  : NONE.
  * NOTES   :
  * MODIFICTION HISTORY:
@@ -2872,7 +3086,8 @@ static SPI_NAND_FLASH_RTN_T spi_nand_load_page_into_cache( u32 page_number)
  */
 static void spi_nand_set_clock_speed( u32 clk)
 {
-
+	if (spi_speed_set(clk) < 0)
+		_SPI_NAND_PRINTF("Set SPI clock setting %u failed\n", clk);
 }
 
 /*------------------------------------------------------------------------------------
@@ -2894,7 +3109,7 @@ static void spi_nand_set_clock_speed( u32 clk)
  *
  *------------------------------------------------------------------------------------
  */
-static SPI_NAND_FLASH_RTN_T spi_nand_block_aligned_check( u32 addr, u32 len )
+static SPI_NAND_FLASH_RTN_T spi_nand_block_aligned_check( u64 addr, u64 len )
 {
 	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
@@ -2921,6 +3136,7 @@ static SPI_NAND_FLASH_RTN_T spi_nand_block_aligned_check( u32 addr, u32 len )
 SPI_NAND_FLASH_RTN_T spi_nand_erase_block ( u32 block_index)
 {
 	u8 status;
+	u32 polls;
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 
 	spi_nand_select_die ( (block_index << _SPI_NAND_BLOCK_ROW_ADDRESS_OFFSET) );
@@ -2932,9 +3148,13 @@ SPI_NAND_FLASH_RTN_T spi_nand_erase_block ( u32 block_index)
 	spi_nand_protocol_block_erase( block_index );
 
 	/* 2.4 Checking status for erase complete */
+	if( _nand_wait.erase_us )
+		usleep( _nand_wait.erase_us );
+	polls = 0;
 	do {
 		spi_nand_protocol_get_status_reg_3( &status);
-	} while( status & _SPI_NAND_VAL_OIP) ;
+	} while( (status & _SPI_NAND_VAL_OIP) && ++polls ) ;
+	stat_record( STAT_OP_ERASE, block_index, polls );
 
 	/* 2.5 Disable write_flash */
 	spi_nand_protocol_write_disable();
@@ -2977,10 +3197,10 @@ SPI_NAND_FLASH_RTN_T spi_nand_erase_block ( u32 block_index)
  *
  *------------------------------------------------------------------------------------
  */
-static SPI_NAND_FLASH_RTN_T spi_nand_erase_internal( u32 addr, u32 len )
+static SPI_NAND_FLASH_RTN_T spi_nand_erase_internal( u64 addr, u64 len )
 {
 	u32 block_index = 0;
-	u32 erase_len = 0;
+	u64 erase_len = 0;
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 #if 0
 	print_dot  = 0;
@@ -3010,7 +3230,7 @@ static SPI_NAND_FLASH_RTN_T spi_nand_erase_internal( u32 addr, u32 len )
 			/* 2.6 Check Erase Fail Bit */
 			if(rtn_status != SPI_NAND_FLASH_RTN_NO_ERROR)
 			{
-				_SPI_NAND_PRINTF("spi_nand_erase_internal : Erase Fail at addr = 0x%x, len = 0x%x, block_idx = 0x%x\n", addr, len, block_index);
+				_SPI_NAND_PRINTF("spi_nand_erase_internal : Erase Fail at addr = 0x%llx, len = 0x%llx, block_idx = 0x%x\n", addr, len, block_index);
 				rtn_status = SPI_NAND_FLASH_RTN_ERASE_FAIL;
 			}
 
@@ -3019,12 +3239,12 @@ static SPI_NAND_FLASH_RTN_T spi_nand_erase_internal( u32 addr, u32 len )
 			erase_len	+= _current_flash_info_t.erase_size;
 			if( timer_progress() )
 			{
-				printf("\bErase %d%% [%u] of [%u] bytes      ", 100 * (erase_len / 1024) / (len / 1024), erase_len, len);
+				printf("\bErase %d%% [%llu] of [%llu] bytes      ", timer_percent(erase_len, len), erase_len, len);
 				printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
 				fflush(stdout);
 			}
 		}
-		printf("Erase 100%% [%u] of [%u] bytes      \n", erase_len, len);
+		printf("Erase 100%% [%llu] of [%llu] bytes      \n", erase_len, len);
 	}
 	else
 	{
@@ -3135,11 +3355,25 @@ noecc:
 	return rtn_status;
 }
 
+/* These parts take PROGRAM LOAD before WRITE ENABLE */
+static int spi_nand_load_before_write_enable( struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t )
+{
+	return ( ((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_GIGADEVICE) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_PN) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_FM) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_XTX) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_FORESEE) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_FISON) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_TYM) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_ATO_2) ||
+		(((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_ATO) && ((ptr_dev_info_t->dev_id) == _SPI_NAND_DEVICE_ID_ATO25D2GA)) );
+}
+
 static SPI_NAND_FLASH_RTN_T spi_nand_write_page( u32 page_number, u32 data_offset, u8  *ptr_data, u32 data_len, u32 oob_offset, u8  *ptr_oob,
 											u32 oob_len, SPI_NAND_FLASH_WRITE_SPEED_MODE_T speed_mode )
 {
 		u8 status, status_2;
-		u32 i = 0, j = 0, idx = 0;
+		u32 i = 0, j = 0, idx = 0, polls;
 		struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
 		struct spi_nand_flash_oobfree *ptr_oob_entry_idx;
 		SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
@@ -3215,15 +3449,7 @@ static SPI_NAND_FLASH_RTN_T spi_nand_write_page( u32 page_number, u32 data_offse
 		spi_nand_select_die ( page_number );
 
 		/* Different Manafacture have different prgoram flow and setting */
-		if( ((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_GIGADEVICE) ||
-			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_PN) ||
-			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_FM) ||
-			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_XTX) ||
-			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_FORESEE) ||
-			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_FISON) ||
-			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_TYM) ||
-			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_ATO_2) ||
-			(((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_ATO) && ((ptr_dev_info_t->dev_id) == _SPI_NAND_DEVICE_ID_ATO25D2GA)))
+		if( spi_nand_load_before_write_enable(ptr_dev_info_t) )
 		{
 			{
 				spi_nand_protocol_program_load(write_addr, &_current_cache_page[0], ((ptr_dev_info_t->page_size) + (ptr_dev_info_t->oob_size)), speed_mode);
@@ -3247,9 +3473,13 @@ static SPI_NAND_FLASH_RTN_T spi_nand_write_page( u32 page_number, u32 data_offse
 		spi_nand_protocol_program_execute ( page_number );
 
 		/* Checking status for erase complete */
+		if( _nand_wait.prog_us )
+			usleep( _nand_wait.prog_us );
+		polls = 0;
 		do {
 			spi_nand_protocol_get_status_reg_3( &status);
-		} while( status & _SPI_NAND_VAL_OIP) ;
+		} while( (status & _SPI_NAND_VAL_OIP) && ++polls ) ;
+		stat_record( STAT_OP_PROGRAM, page_number / ((ptr_dev_info_t->erase_size) / (ptr_dev_info_t->page_size)), polls );
 
 		/*. Disable write_flash */
 		spi_nand_protocol_write_disable();
@@ -3277,6 +3507,301 @@ static SPI_NAND_FLASH_RTN_T spi_nand_write_page( u32 page_number, u32 data_offse
 		return (rtn_status);
 }
 
+/*------------------------------------------------------------------------------------
+ * FUNCTION: static SPI_NAND_FLASH_RTN_T spi_nand_write_oob( u32 page_number,
+ *                                                           u32 oob_offset,
+ *                                                           u8  *ptr_oob,
+ *                                                           u32 oob_len,
+ *                                                           int raw )
+ * PURPOSE : To program OOB bytes only. The first span goes in with PROGRAM LOAD at its
+ *           column past the page data, which sets the rest of the cache to 0xFF, and
+ *           further spans with PROGRAM LOAD RANDOM, so only the OOB bytes cross the bus.
+ * AUTHOR  :
+ * CALLED BY
+ *   -
+ * CALLS
+ *   -
+ * PARAMs  :
+ *   INPUT : page_number - The page number.
+ *           oob_offset  - Offset in the free OOB bytes, or the raw OOB offset if raw.
+ *           ptr_oob     - The OOB bytes.
+ *           oob_len     - The number of OOB bytes.
+ *           raw         - 0: map through oobfree of the chip, bad block marker bytes
+ *                         excluded.   1: raw OOB offset.
+ *   OUTPUT: None
+ * RETURN  : SPI_RTN_NO_ERROR - Successful.   Otherwise - Failed.
+ * NOTES   :
+ * MODIFICTION HISTORY:
+ *
+ *------------------------------------------------------------------------------------
+ */
+static SPI_NAND_FLASH_RTN_T spi_nand_write_oob( u32 page_number, u32 oob_offset, u8 *ptr_oob, u32 oob_len, int raw )
+{
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
+	struct spi_nand_flash_oobfree *ptr_oob_entry_idx;
+	u32 col[SPI_NAND_FLASH_OOB_FREE_ENTRY_MAX], src[SPI_NAND_FLASH_OOB_FREE_ENTRY_MAX], cnt[SPI_NAND_FLASH_OOB_FREE_ENTRY_MAX];
+	u32 i, idx, start, end, from, to, n = 0, done = 0, polls;
+	u32 column, oob_size;
+	u8 status;
+	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
+
+	ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+
+	/* Without on-die ECC (-d) the page size takes in the OOB */
+	column = ptr_dev_info_t->page_size;
+	oob_size = ptr_dev_info_t->oob_size;
+	if( !ECC_fcheck )
+	{
+		column -= bmt_oob_size;
+		oob_size = bmt_oob_size;
+	}
+
+	/* Cut the OOB bytes into column spans */
+	if( raw )
+	{
+		if( oob_offset + oob_len > oob_size )
+			return SPI_NAND_FLASH_RTN_PROGRAM_FAIL;
+		col[0] = column + oob_offset;
+		src[0] = 0;
+		cnt[0] = oob_len;
+		n = 1;
+		done = oob_len;
+	}
+	else
+	{
+		ptr_oob_entry_idx = (struct spi_nand_flash_oobfree*) &( ptr_dev_info_t->oob_free_layout->oobfree );
+		for( i = 0, idx = 0; (i < SPI_NAND_FLASH_OOB_FREE_ENTRY_MAX) && (ptr_oob_entry_idx[i].len) && (done < oob_len); i++ )
+		{
+			start = ptr_oob_entry_idx[i].offset;
+			end = start + ptr_oob_entry_idx[i].len;
+			if( start < _SPI_NAND_BBM_BYTES )
+				start = _SPI_NAND_BBM_BYTES;
+			if( start >= end )
+				continue;
+			/* Free bytes idx..idx+(end-start) of this entry overlap the request? */
+			from = oob_offset > idx ? oob_offset - idx : 0;
+			to = oob_offset + oob_len - idx;
+			if( to > end - start )
+				to = end - start;
+			if( from < to )
+			{
+				col[n] = column + start + from;
+				src[n] = idx + from - oob_offset;
+				cnt[n] = to - from;
+				done += cnt[n];
+				n++;
+			}
+			idx += end - start;
+		}
+	}
+	if( done < oob_len )
+	{
+		_SPI_NAND_PRINTF("spi_nand_write_oob : %u OOB bytes at %u do not fit the free OOB area\n", oob_len, oob_offset);
+		return SPI_NAND_FLASH_RTN_PROGRAM_FAIL;
+	}
+
+	_SPI_NAND_ENABLE_MANUAL_MODE();
+
+	if( ((ptr_dev_info_t->feature) & SPI_NAND_FLASH_PLANE_SELECT_HAVE) )
+		_plane_select_bit = ((page_number >> 6) & (0x1));
+
+	spi_nand_select_die ( page_number );
+
+	if( !spi_nand_load_before_write_enable(ptr_dev_info_t) )
+		spi_nand_protocol_write_enable();
+
+	for( i = 0; i < n; i++ )
+	{
+		if( i == 0 )
+			spi_nand_protocol_program_load(col[i], &ptr_oob[src[i]], cnt[i], SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE);
+		else
+			spi_nand_protocol_program_load_random(col[i], &ptr_oob[src[i]], cnt[i], SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE);
+	}
+
+	if( spi_nand_load_before_write_enable(ptr_dev_info_t) )
+		spi_nand_protocol_write_enable();
+
+	spi_nand_protocol_program_execute ( page_number );
+
+	if( _nand_wait.prog_us )
+		usleep( _nand_wait.prog_us );
+	polls = 0;
+	do {
+		spi_nand_protocol_get_status_reg_3( &status);
+	} while( (status & _SPI_NAND_VAL_OIP) && ++polls ) ;
+	stat_record( STAT_OP_PROGRAM, page_number / ((ptr_dev_info_t->erase_size) / (ptr_dev_info_t->page_size)), polls );
+
+	spi_nand_protocol_write_disable();
+
+	if( status & _SPI_NAND_VAL_PROGRAM_FAIL )
+	{
+		_SPI_NAND_PRINTF("spi_nand_write_oob : Program Fail at page_number = 0x%x, status = 0x%x\n", page_number, status);
+		rtn_status = SPI_NAND_FLASH_RTN_PROGRAM_FAIL;
+	}
+
+	SPI_NAND_Flash_Clear_Read_Cache_Data();
+
+	return (rtn_status);
+}
+
+/* These parts keep the cache register after PROGRAM EXECUTE, so one PROGRAM LOAD serves many rows */
+static int spi_nand_cache_kept_after_program( struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t )
+{
+	unsigned long v;
+
+	/* Plane and die select switch the cache register */
+	if( (ptr_dev_info_t->feature) & (SPI_NAND_FLASH_PLANE_SELECT_HAVE | SPI_NAND_FLASH_DIE_SELECT_1_HAVE | SPI_NAND_FLASH_DIE_SELECT_2_HAVE) )
+		return 0;
+	/* A sample that read back wrong turned it off for the part */
+	if( !profile_get(ptr_dev_info_t->ptr_name, _SPI_NAND_CACHE_KEEP_KEY, &v) )
+		return v;
+	return ( ((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_WINBOND) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_MICRON) ||
+		((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_SIM) );
+}
+
+/*------------------------------------------------------------------------------------
+ * FUNCTION: static SPI_NAND_FLASH_RTN_T spi_nand_program_pattern( u32 first_page,
+ *                                                                 u32 pages,
+ *                                                                 u8  *ptr_page,
+ *                                                                 u32 *ptr_loads,
+ *                                                                 int learn )
+ * PURPOSE : To program the same page content to successive rows. Where the cache
+ *           register survives PROGRAM EXECUTE the page is loaded once and every
+ *           further row only takes WRITE ENABLE + PROGRAM EXECUTE. Sample rows are
+ *           read back; on a mismatch the block of the row is erased and programmed
+ *           again with a PROGRAM LOAD for every row. Only when the row then reads
+ *           back right does the part not keep the cache, with learn that is
+ *           remembered for the part.
+ * AUTHOR  :
+ * CALLED BY
+ *   -
+ * CALLS
+ *   -
+ * PARAMs  :
+ *   INPUT : first_page - The first page number.
+ *           pages      - The number of pages, whole erased blocks.
+ *           ptr_page   - The page with its OOB as PROGRAM LOAD takes it.
+ *           learn      - Keep a confirmed cache loss in the profile.
+ *   OUTPUT: ptr_loads  - The number of PROGRAM LOADs sent.
+ * RETURN  : SPI_RTN_NO_ERROR - Successful.   Otherwise - Failed.
+ * NOTES   :
+ * MODIFICTION HISTORY:
+ *
+ *------------------------------------------------------------------------------------
+ */
+static SPI_NAND_FLASH_RTN_T spi_nand_program_pattern( u32 first_page, u32 pages, u8 *ptr_page, u32 *ptr_loads, int learn )
+{
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
+	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
+	u32 page_number, polls, since_load = 0, sample = 1, load_size, ppb;
+	u32 suspect = 0xffffffff;
+	int reuse, loaded = 0, load_first;
+	u8 status;
+
+	ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+	load_size = (ptr_dev_info_t->page_size) + (ptr_dev_info_t->oob_size);
+	ppb = (ptr_dev_info_t->erase_size) / (ptr_dev_info_t->page_size);
+	reuse = spi_nand_cache_kept_after_program(ptr_dev_info_t);
+	load_first = spi_nand_load_before_write_enable(ptr_dev_info_t);
+	*ptr_loads = 0;
+
+	_SPI_NAND_ENABLE_MANUAL_MODE();
+
+	for( page_number = first_page; page_number < first_page + pages; page_number++ )
+	{
+		spi_nand_select_die ( page_number );
+
+		if( !loaded || !reuse )
+		{
+			if( !load_first )
+				spi_nand_protocol_write_enable();
+			spi_nand_protocol_program_load(0, ptr_page, load_size, SPI_NAND_FLASH_WRITE_SPEED_MODE_SINGLE);
+			if( load_first )
+				spi_nand_protocol_write_enable();
+			(*ptr_loads)++;
+			loaded = 1;
+			since_load = 0;
+		}
+		else
+		{
+			spi_nand_protocol_write_enable();
+		}
+
+		spi_nand_protocol_program_execute ( page_number );
+
+		if( _nand_wait.prog_us )
+			usleep( _nand_wait.prog_us );
+		polls = 0;
+		do {
+			spi_nand_protocol_get_status_reg_3( &status);
+		} while( (status & _SPI_NAND_VAL_OIP) && ++polls ) ;
+		stat_record( STAT_OP_PROGRAM, page_number / ppb, polls );
+
+		spi_nand_protocol_write_disable();
+
+		if( status & _SPI_NAND_VAL_PROGRAM_FAIL )
+		{
+			_SPI_NAND_PRINTF("spi_nand_program_pattern : Program Fail at page_number = 0x%x, status = 0x%x\n", page_number, status);
+			rtn_status = SPI_NAND_FLASH_RTN_PROGRAM_FAIL;
+		}
+
+		/*
+		 * A row programmed from the reused cache is read back, the second row
+		 * right away and then one per _SPI_NAND_PATTERN_RELOAD. PAGE READ
+		 * overwrites the cache, so the next row loads again.
+		 */
+		if( page_number == suspect )
+		{
+			/* The row again, from its own PROGRAM LOAD on an erased block */
+			suspect = 0xffffffff;
+			SPI_NAND_Flash_Clear_Read_Cache_Data();
+			spi_nand_read_page(page_number, ptr_dev_info_t->read_mode);
+			if( memcmp(_current_cache_page_data, ptr_page, ptr_dev_info_t->page_size) )
+			{
+				_SPI_NAND_PRINTF("spi_nand_program_pattern : page 0x%x read back wrong after a fresh program load\n", page_number);
+				rtn_status = SPI_NAND_FLASH_RTN_PROGRAM_FAIL;
+			}
+			else
+			{
+				_SPI_NAND_PRINTF("spi_nand_program_pattern : %s does not keep the cache after program, reloading every page\n",
+					ptr_dev_info_t->ptr_name);
+				if( learn )
+					profile_set(ptr_dev_info_t->ptr_name, _SPI_NAND_CACHE_KEEP_KEY, 0);
+			}
+		}
+		else if( reuse && since_load++ == sample )
+		{
+			sample = _SPI_NAND_PATTERN_RELOAD - 1;
+			SPI_NAND_Flash_Clear_Read_Cache_Data();
+			spi_nand_read_page(page_number, ptr_dev_info_t->read_mode);
+			if( memcmp(_current_cache_page_data, ptr_page, ptr_dev_info_t->page_size) )
+			{
+				reuse = 0;
+				if( spi_nand_erase_block(page_number / ppb) == SPI_NAND_FLASH_RTN_NO_ERROR )
+				{
+					_SPI_NAND_PRINTF("spi_nand_program_pattern : page 0x%x read back wrong, programming its block again from fresh loads\n", page_number);
+					suspect = page_number;
+					page_number -= page_number % ppb;
+					if( page_number < first_page )
+						page_number = first_page;
+					page_number--;
+				}
+				else
+				{
+					_SPI_NAND_PRINTF("spi_nand_program_pattern : page 0x%x read back wrong, reloading every page\n", page_number);
+					rtn_status = SPI_NAND_FLASH_RTN_PROGRAM_FAIL;
+				}
+			}
+			loaded = 0;
+		}
+	}
+
+	SPI_NAND_Flash_Clear_Read_Cache_Data();
+
+	return (rtn_status);
+}
+
 int test_write_fail_flag = 0;
 
 /*------------------------------------------------------------------------------------
@@ -3301,10 +3826,10 @@ int test_write_fail_flag = 0;
  *
  *------------------------------------------------------------------------------------
  */
-static SPI_NAND_FLASH_RTN_T spi_nand_write_internal( u32 dst_addr, u32 len, u32 *ptr_rtn_len, u8* ptr_buf, SPI_NAND_FLASH_WRITE_SPEED_MODE_T speed_mode )
+static SPI_NAND_FLASH_RTN_T spi_nand_write_internal( u64 dst_addr, u64 len, u64 *ptr_rtn_len, u8* ptr_buf, SPI_NAND_FLASH_WRITE_SPEED_MODE_T speed_mode )
 {
-	u32 remain_len, write_addr, data_len, page_number, physical_dst_addr;
-	u32 addr_offset;
+	u64 remain_len, write_addr, physical_dst_addr;
+	u32 data_len, page_number, addr_offset;
 	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 #if 0
@@ -3345,15 +3870,15 @@ static SPI_NAND_FLASH_RTN_T spi_nand_write_internal( u32 dst_addr, u32 len, u32
 		/* 8. Write remain data if neccessary */
 		write_addr += data_len;
 		remain_len -= data_len;
-		ptr_rtn_len += data_len;
+		*ptr_rtn_len += data_len;
 		if( timer_progress() )
 		{
-			printf("\bWritten %d%% [%u] of [%u] bytes      ", 100 * ((len - remain_len) / 1024) / (len / 1024), len - remain_len, len);
+			printf("\bWritten %d%% [%llu] of [%llu] bytes      ", timer_percent(len - remain_len, len), len - remain_len, len);
 			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
 			fflush(stdout);
 		}
 	}
-	printf("Written 100%% [%u] of [%u] bytes      \n", len - remain_len, len);
+	printf("Written 100%% [%llu] of [%llu] bytes      \n", len - remain_len, len);
 	_SPI_NAND_SEMAPHORE_UNLOCK();
 
 	return (rtn_status);
@@ -3379,11 +3904,11 @@ static SPI_NAND_FLASH_RTN_T spi_nand_write_internal( u32 dst_addr, u32 len, u32
  *
  *------------------------------------------------------------------------------------
  */
-static SPI_NAND_FLASH_RTN_T spi_nand_read_internal ( u32 addr, u32 len, u8 *ptr_rtn_buf, SPI_NAND_FLASH_READ_SPEED_MODE_T speed_mode,
+static SPI_NAND_FLASH_RTN_T spi_nand_read_internal ( u64 addr, u64 len, u8 *ptr_rtn_buf, SPI_NAND_FLASH_READ_SPEED_MODE_T speed_mode,
 									SPI_NAND_FLASH_RTN_T *status)
 {
 	u32 page_number, data_offset;
-	u32 read_addr, physical_read_addr, remain_len;
+	u64 read_addr, physical_read_addr, remain_len;
 	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 
@@ -3430,12 +3955,12 @@ static SPI_NAND_FLASH_RTN_T spi_nand_read_internal ( u32 addr, u32 len, u8 *ptr_
 		}
 		if( timer_progress() )
 		{
-			printf("\bRead %d%% [%u] of [%u] bytes      ", 100 * ((len - remain_len) / 1024) / (len / 1024), len - remain_len, len);
+			printf("\bRead %d%% [%llu] of [%llu] bytes      ", timer_percent(len - remain_len, len), len - remain_len, len);
 			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
 			fflush(stdout);
 		}
 	}
-	printf("Read 100%% [%u] of [%u] bytes      \n", len - remain_len, len);
+	printf("Read 100%% [%llu] of [%llu] bytes      \n", len - remain_len, len);
 	_SPI_NAND_SEMAPHORE_UNLOCK();
 
 	return (rtn_status);
@@ -3856,6 +4381,11 @@ static void spi_nand_manufacute_init( struct SPI_NAND_FLASH_INFO_T *ptr_device_t
 static SPI_NAND_FLASH_RTN_T spi_nand_compare( const struct SPI_NAND_FLASH_INFO_T *ptr_rtn_device_t,
 					      const struct SPI_NAND_FLASH_INFO_T *spi_nand_flash_table )
 {
+	if ( (spi_nand_flash_table->feature & SPI_NAND_FLASH_SIM_ONLY) && !sim_enable )
+	{
+		return SPI_NAND_FLASH_RTN_PROBE_ERROR;
+	}
+
 	if ( spi_nand_flash_table->dev_id_2 == 0 )
 	{
 		_SPI_NAND_DEBUG_PRINTF(SPI_NAND_FLASH_DEBUG_LEVEL_1, "spi_nand_compare: mfr_id = 0x%x, dev_id = 0x%x\n",
@@ -3929,6 +4459,7 @@ static SPI_NAND_FLASH_RTN_T spi_nand_probe( struct SPI_NAND_FLASH_INFO_T *ptr_rt
 			memcpy( &(ptr_rtn_device_t->ptr_name) , &(spi_nand_flash_tables[i].ptr_name), sizeof(ptr_rtn_device_t->ptr_name));
 			memcpy( &(ptr_rtn_device_t->oob_free_layout) , &(spi_nand_flash_tables[i].oob_free_layout), sizeof(ptr_rtn_device_t->oob_free_layout));
 			ptr_rtn_device_t->feature = spi_nand_flash_tables[i].feature;
+			ptr_rtn_device_t->timing  = spi_nand_flash_tables[i].timing;
 
 			rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 			break;
@@ -3959,6 +4490,7 @@ static SPI_NAND_FLASH_RTN_T spi_nand_probe( struct SPI_NAND_FLASH_INFO_T *ptr_rt
 				memcpy( &(ptr_rtn_device_t->ptr_name) , &(spi_nand_flash_tables[i].ptr_name), sizeof(ptr_rtn_device_t->ptr_name));
 				memcpy( &(ptr_rtn_device_t->oob_free_layout) , &(spi_nand_flash_tables[i].oob_free_layout), sizeof(ptr_rtn_device_t->oob_free_layout));
 				ptr_rtn_device_t->feature = spi_nand_flash_tables[i].feature;
+				ptr_rtn_device_t->timing  = spi_nand_flash_tables[i].timing;
 
 				rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 				break;
@@ -3993,6 +4525,7 @@ static SPI_NAND_FLASH_RTN_T spi_nand_probe( struct SPI_NAND_FLASH_INFO_T *ptr_rt
 				memcpy( &(ptr_rtn_device_t->ptr_name) , &(spi_nand_flash_tables[i].ptr_name), sizeof(ptr_rtn_device_t->ptr_name));
 				memcpy( &(ptr_rtn_device_t->oob_free_layout) , &(spi_nand_flash_tables[i].oob_free_layout), sizeof(ptr_rtn_device_t->oob_free_layout));
 				ptr_rtn_device_t->feature = spi_nand_flash_tables[i].feature;
+				ptr_rtn_device_t->timing  = spi_nand_flash_tables[i].timing;
 
 				rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 				break;
@@ -4048,8 +4581,8 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Init(u32 rom_base)
 {
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_PROBE_ERROR;
 
-	/* 1. set SFC Clock to 50MHZ  */
-	spi_nand_set_clock_speed(50);
+	/* 1. set SFC Clock, chosen by the fallback ladder or the user */
+	spi_nand_set_clock_speed(spi_speed);
 
 	/* 2. Enable Manual Mode */
 	_SPI_NAND_ENABLE_MANUAL_MODE();
@@ -4068,7 +4601,7 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Init(u32 rom_base)
 			_SPI_NAND_PRINTF("Disable Flash ECC.\n");
 		}
 		SPI_NAND_Flash_Enable_OnDie_ECC();
-		_SPI_NAND_PRINTF("Detected SPI NAND Flash: %s, Flash Size: %d MB\n", _current_flash_info_t.ptr_name,  ECC_fcheck ? _current_flash_info_t.device_size >> 20 : (_current_flash_info_t.device_size - ecc_size) >> 20);
+		_SPI_NAND_PRINTF("Detected SPI NAND Flash: %s, Flash Size: %d MB\n", _current_flash_info_t.ptr_name,  (int)(ECC_fcheck ? _current_flash_info_t.device_size >> 20 : (_current_flash_info_t.device_size - ecc_size) >> 20));
 
 		rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 	}
@@ -4139,7 +4672,7 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Set_Flash_Info( struct SPI_NAND_FLASH_INFO_T
  *
  *------------------------------------------------------------------------------------
  */
-SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u32 dst_addr, u32 len, u32 *ptr_rtn_len, u8 *ptr_buf,
+SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u64 dst_addr, u64 len, u64 *ptr_rtn_len, u8 *ptr_buf,
 						SPI_NAND_FLASH_WRITE_SPEED_MODE_T speed_node )
 {
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
@@ -4174,7 +4707,7 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u32 dst_addr, u32 len, u32 *ptr
  *
  *------------------------------------------------------------------------------------
  */
-u32 SPI_NAND_Flash_Read_NByte(u32  addr, u32  len, u32  *retlen, u8 *buf, SPI_NAND_FLASH_READ_SPEED_MODE_T speed_mode,
+u32 SPI_NAND_Flash_Read_NByte(u64  addr, u64  len, u64  *retlen, u8 *buf, SPI_NAND_FLASH_READ_SPEED_MODE_T speed_mode,
 						SPI_NAND_FLASH_RTN_T *status)
 {
 	return spi_nand_read_internal(addr, len, buf, speed_mode, status);
@@ -4199,7 +4732,7 @@ u32 SPI_NAND_Flash_Read_NByte(u32  addr, u32  len, u32  *retlen, u8 *buf, SPI_NA
  *
  *------------------------------------------------------------------------------------
  */
-SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Erase( u32 dst_addr, u32 len )
+SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Erase( u64 dst_addr, u64 len )
 {
 	SPI_NAND_FLASH_RTN_T rtn_status = SPI_NAND_FLASH_RTN_NO_ERROR;
 
@@ -4326,7 +4859,10 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Enable_OnDie_ECC( void )
 			/* Value check*/
 			spi_nand_protocol_get_status_reg_2(&feature);
 			_SPI_NAND_DEBUG_PRINTF(SPI_NAND_FLASH_DEBUG_LEVEL_1, "after setting : SPI_NAND_Flash_Enable_OnDie_ECC, status reg = 0x%x\n", feature);
+			if( i < _SPI_NAND_ECC_DIES_MAX )
+				_ecc_feature[i] = feature;
 		}
+		_die_id = die_num - 1;
 	} else if(((ptr_dev_info_t->feature) & SPI_NAND_FLASH_DIE_SELECT_2_HAVE)) {
 		die_num = (ptr_dev_info_t->device_size / ptr_dev_info_t->page_size) >> 17;
 
@@ -4344,7 +4880,10 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Enable_OnDie_ECC( void )
 			/* Value check*/
 			spi_nand_protocol_get_status_reg_2(&feature);
 			_SPI_NAND_DEBUG_PRINTF(SPI_NAND_FLASH_DEBUG_LEVEL_1, "after setting : SPI_NAND_Flash_Enable_OnDie_ECC, status reg = 0x%x\n", feature);
+			if( i < _SPI_NAND_ECC_DIES_MAX )
+				_ecc_feature[i] = feature;
 		}
+		_die_id = die_num - 1;
 	} else {
 		if( ((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_PN) ||
 			((ptr_dev_info_t->mfr_id) == _SPI_NAND_MANUFACTURER_ID_FM) ||
@@ -4362,6 +4901,8 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Enable_OnDie_ECC( void )
 			/* Value check*/
 			spi_nand_protocol_get_feature(_SPI_NAND_ADDR_ECC, &feature);
 			_SPI_NAND_DEBUG_PRINTF(SPI_NAND_FLASH_DEBUG_LEVEL_1, "after setting : SPI_NAND_Flash_Enable_OnDie_ECC, ecc reg = 0x%x\n", feature);
+			_ecc_feature_addr = _SPI_NAND_ADDR_ECC;
+			_ecc_feature[0] = feature;
 		}
 		else
 		{
@@ -4377,6 +4918,8 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Enable_OnDie_ECC( void )
 			/* Value check*/
 			spi_nand_protocol_get_status_reg_2(&feature);
 			_SPI_NAND_DEBUG_PRINTF(SPI_NAND_FLASH_DEBUG_LEVEL_1, "after setting : SPI_NAND_Flash_Enable_OnDie_ECC, status reg = 0x%x\n", feature);
+			_ecc_feature_addr = _SPI_NAND_ADDR_FEATURE;
+			_ecc_feature[0] = feature;
 		}
 	}
 
@@ -4399,14 +4942,14 @@ int nandflash_init(int rom_base)
 	}
 }
 
-int nandflash_read(unsigned long from, unsigned long len, unsigned long *retlen, unsigned char *buf, SPI_NAND_FLASH_RTN_T *status)
+int nandflash_read(unsigned long long from, unsigned long long len, unsigned long long *retlen, unsigned char *buf, SPI_NAND_FLASH_RTN_T *status)
 {
 	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
 
 	ptr_dev_info_t  = _SPI_NAND_GET_DEVICE_INFO_PTR;
 
 	timer_start();
-	if( SPI_NAND_Flash_Read_NByte(from, len, (u32 *)retlen, buf, ptr_dev_info_t->read_mode, status) == SPI_NAND_FLASH_RTN_NO_ERROR )
+	if( SPI_NAND_Flash_Read_NByte(from, len, retlen, buf, ptr_dev_info_t->read_mode, status) == SPI_NAND_FLASH_RTN_NO_ERROR )
 	{
 		timer_end();
 		return 0;
@@ -4417,7 +4960,7 @@ int nandflash_read(unsigned long from, unsigned long len, unsigned long *retlen,
 	}
 }
 
-int nandflash_erase(unsigned long offset, unsigned long len)
+int nandflash_erase(unsigned long long offset, unsigned long long len)
 {
 	timer_start();
 	if( SPI_NAND_Flash_Erase(offset, len) == SPI_NAND_FLASH_RTN_NO_ERROR )
@@ -4431,14 +4974,14 @@ int nandflash_erase(unsigned long offset, unsigned long len)
 	}
 }
 
-int nandflash_write(unsigned long to, unsigned long len, unsigned long *retlen, unsigned char *buf)
+int nandflash_write(unsigned long long to, unsigned long long len, unsigned long long *retlen, unsigned char *buf)
 {
 	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t;
 
 	ptr_dev_info_t  = _SPI_NAND_GET_DEVICE_INFO_PTR;
 
 	timer_start();
-	if( SPI_NAND_Flash_Write_Nbyte(to, len, (u32 *)retlen, buf, ptr_dev_info_t->write_mode) == SPI_NAND_FLASH_RTN_NO_ERROR )
+	if( SPI_NAND_Flash_Write_Nbyte(to, len, retlen, buf, ptr_dev_info_t->write_mode) == SPI_NAND_FLASH_RTN_NO_ERROR )
 	{
 		timer_end();
 		return 0;
@@ -4450,40 +4993,332 @@ int nandflash_write(unsigned long to, unsigned long len, unsigned long *retlen,
 }
 /* End of [spi_nand_flash.c] package */
 
-int snand_read(unsigned char *buf, unsigned long from, unsigned long len)
+long long snand_read(unsigned char *buf, unsigned long long from, unsigned long long len)
 {
-	unsigned long retlen = 0;
+	unsigned long long retlen = 0;
 	SPI_NAND_FLASH_RTN_T status;
 
-	if(!nandflash_read((unsigned long)from, (unsigned long)len, &retlen, buf, &status))
+	if(!nandflash_read(from, len, &retlen, buf, &status))
 		return len;
 	return -1;
 }
 
-int snand_erase(unsigned long offs, unsigned long len)
+int snand_erase(unsigned long long offs, unsigned long long len)
 {
-	return nandflash_erase((unsigned long)offs, (unsigned long)len);
+	return nandflash_erase(offs, len);
 }
 
-int snand_write(unsigned char *buf, unsigned long to, unsigned long len)
+long long snand_write(unsigned char *buf, unsigned long long to, unsigned long long len)
 {
-	unsigned long retlen = 0;
+	unsigned long long retlen = 0;
 
-	if(!nandflash_write((unsigned long)to, (unsigned long)len, &retlen, buf))
-		return (int)retlen;
+	if(!nandflash_write(to, len, &retlen, buf))
+		return retlen;
 	return -1;
 }
 
-long snand_init(void)
+static int snand_stat_poll(void)
+{
+	u8 status;
+
+	return spi_nand_protocol_get_status_reg_3(&status);
+}
+
+long long snand_init(void)
 {
 	if(!nandflash_init(0)) {
 		struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
 		bsize = ptr_dev_info_t->erase_size;
-		return (long)(ptr_dev_info_t->device_size);
+		stat_load_timing(ptr_dev_info_t->ptr_name, ptr_dev_info_t->timing, &_nand_wait);
+		stat_begin(ptr_dev_info_t->ptr_name, ptr_dev_info_t->device_size / ptr_dev_info_t->erase_size, snand_stat_poll, &_nand_wait);
+		return ptr_dev_info_t->device_size;
 	}
 	return -1;
 }
 
+int snand_cleanmarker(unsigned long long offs, unsigned long long len)
+{
+	/* JFFS2 NAND cleanmarker: magic 1985h, node type 2003h, length 8, little endian */
+	static unsigned char cleanmarker[8] = { 0x85, 0x19, 0x03, 0x20, 0x08, 0x00, 0x00, 0x00 };
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+	unsigned long pages = ptr_dev_info_t->erase_size / ptr_dev_info_t->page_size;
+	unsigned long block, first = offs / ptr_dev_info_t->erase_size;
+	unsigned long last = (offs + len - 1) / ptr_dev_info_t->erase_size;
+	int ret = 0;
+
+	timer_start();
+	for (block = first; block <= last; block++) {
+		if (spi_nand_write_oob(block * pages, 0, cleanmarker, sizeof(cleanmarker), 0) != SPI_NAND_FLASH_RTN_NO_ERROR) {
+			printf("Cleanmarker failed in block %lu\n", block);
+			ret = -1;
+		}
+		if (timer_progress()) {
+			printf("\bCleanmarkers %lu%% [%lu] of [%lu] blocks      ", 100 * (block - first + 1) / (last - first + 1), block - first + 1, last - first + 1);
+			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+			fflush(stdout);
+		}
+	}
+	printf("Cleanmarkers 100%% [%lu] of [%lu] blocks      \n", last - first + 1, last - first + 1);
+	timer_end();
+
+	return ret;
+}
+
+int snand_mark_bad(unsigned long long offs)
+{
+	static unsigned char bbm[_SPI_NAND_BBM_BYTES] = { 0x00, 0x00 };
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+	unsigned long block = offs / ptr_dev_info_t->erase_size;
+
+	printf("Mark block %lu (0x%08llX) bad\n", block, (unsigned long long)block * ptr_dev_info_t->erase_size);
+	return spi_nand_write_oob(block * (ptr_dev_info_t->erase_size / ptr_dev_info_t->page_size), 0,
+			bbm, sizeof(bbm), 1) == SPI_NAND_FLASH_RTN_NO_ERROR ? 0 : -1;
+}
+
+/* Bad block marker: the first OOB bytes of the first page, anything but FFh is bad */
+int snand_block_bad(unsigned long block)
+{
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+	u32 page_number = block * (ptr_dev_info_t->erase_size / ptr_dev_info_t->page_size);
+	u32 column = ptr_dev_info_t->page_size;
+	u8 bbm[_SPI_NAND_BBM_BYTES];
+	u8 status;
+	int i;
+
+	/* Without on-die ECC (-d) the page size takes in the OOB */
+	if( !ECC_fcheck )
+		column -= bmt_oob_size;
+
+	_SPI_NAND_ENABLE_MANUAL_MODE();
+
+	if( ((ptr_dev_info_t->feature) & SPI_NAND_FLASH_PLANE_SELECT_HAVE) )
+		_plane_select_bit = ((page_number >> 6) & (0x1));
+
+	/* Only the marker is wanted, the ECC status of the page does not matter */
+	spi_nand_select_die ( page_number );
+	spi_nand_protocol_page_read ( page_number );
+	do {
+		spi_nand_protocol_get_status_reg_3( &status);
+	} while( status & _SPI_NAND_VAL_OIP) ;
+	SPI_NAND_Flash_Clear_Read_Cache_Data();
+
+	if( spi_nand_protocol_read_from_cache(column, sizeof(bbm), bbm,
+			ptr_dev_info_t->read_mode, ptr_dev_info_t->dummy_mode) != SPI_NAND_FLASH_RTN_NO_ERROR )
+		return -1;
+	for (i = 0; i < sizeof(bbm); i++)
+		if (bbm[i] != 0xff)
+			return 1;
+	return 0;
+}
+
+int snand_program_pattern(unsigned long long offs, unsigned long long len, const unsigned char *pattern, unsigned long plen, int fill)
+{
+	static u8 page[_SPI_NAND_CACHE_SIZE];
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+	unsigned long i, pages, ppb, block, done, bad = 0;
+	u32 loads = 0, n;
+	int ret = 0, r;
+
+	if (!plen || offs % ptr_dev_info_t->page_size || len % ptr_dev_info_t->page_size) {
+		printf("Pattern range must be whole pages of 0x%X bytes\n", ptr_dev_info_t->page_size);
+		return -1;
+	}
+	if (fill && (offs % ptr_dev_info_t->erase_size || len % ptr_dev_info_t->erase_size)) {
+		printf("Fill range must be whole blocks of 0x%X bytes\n", ptr_dev_info_t->erase_size);
+		return -1;
+	}
+
+	/* The pattern repeats over the page, with on-die ECC the OOB is left to the chip */
+	memset(page, 0xff, sizeof(page));
+	for (i = 0; i < ptr_dev_info_t->page_size; i++)
+		page[i] = pattern[i % plen];
+	for (i = 0; i < ptr_dev_info_t->page_size && page[i] == 0xff; i++)
+		;
+	if (i == ptr_dev_info_t->page_size && !fill) {
+		printf("Pattern is all 0xFF, nothing to program\n");
+		return 0;
+	}
+
+	pages = len / ptr_dev_info_t->page_size;
+	timer_start();
+	if (!fill) {
+		/* The caller erased the range */
+		if (spi_nand_program_pattern(offs / ptr_dev_info_t->page_size, pages, page, &loads, 0) != SPI_NAND_FLASH_RTN_NO_ERROR)
+			ret = -1;
+	} else {
+		/* A block at a time: bad ones are left alone, good ones erased and programmed */
+		ppb = ptr_dev_info_t->erase_size / ptr_dev_info_t->page_size;
+		for (block = offs / ptr_dev_info_t->erase_size; block < (offs + len) / ptr_dev_info_t->erase_size; block++) {
+			if ((r = snand_block_bad(block)) != 0) {
+				if (r < 0) {
+					printf("Bad block marker read failed in block %lu\n", block);
+					ret = -1;
+					break;
+				}
+				printf("\nSkip bad block %lu (0x%08llX)\n", block, (unsigned long long)block * ptr_dev_info_t->erase_size);
+				bad++;
+				continue;
+			}
+			if (spi_nand_erase_block(block) != SPI_NAND_FLASH_RTN_NO_ERROR) {
+				ret = -1;
+				continue;
+			}
+			if (i < ptr_dev_info_t->page_size) {
+				if (spi_nand_program_pattern(block * ppb, ppb, page, &n, 1) != SPI_NAND_FLASH_RTN_NO_ERROR)
+					ret = -1;
+				loads += n;
+			}
+			if (timer_progress()) {
+				done = (block + 1) * ppb - (unsigned long)(offs / ptr_dev_info_t->page_size);
+				printf("\bPattern %d%% [%lu] of [%lu] pages      ", timer_percent(done, pages), done, pages);
+				printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+				fflush(stdout);
+			}
+		}
+	}
+	printf("Pattern 100%% [%lu] of [%lu] pages, %u program loads", pages, pages, loads);
+	if (fill)
+		printf(", %lu bad blocks skipped", bad);
+	printf("      \n");
+	timer_end();
+
+	return ret;
+}
+
+void snand_info(struct flash_info *info)
+{
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+
+	memset(info, 0, sizeof(*info));
+	info->name             = ptr_dev_info_t->ptr_name;
+	info->page_size        = ptr_dev_info_t->page_size;
+	info->erase_size       = ptr_dev_info_t->erase_size;
+	info->skip_blank       = 1;
+	info->read_before_prog = 1;
+	info->read_op          = "PAGE READ 13h + READ FROM CACHE 03h";
+	info->prog_op          = "PROGRAM LOAD 02h + PROGRAM EXECUTE 10h";
+	info->erase_op         = "BLOCK ERASE D8h";
+	info->timing           = ptr_dev_info_t->timing;
+}
+
+/* Table geometry of the detected chip whatever the ECC mode, sizes without the OOB */
+void snand_ecc_geometry(struct snand_geometry *geo)
+{
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+
+	geo->name       = ptr_dev_info_t->ptr_name;
+	geo->oob_size   = bmt_oob_size;
+	geo->page_size  = ptr_dev_info_t->page_size - (ECC_fcheck ? 0 : bmt_oob_size);
+	geo->erase_size = ptr_dev_info_t->erase_size - (ECC_fcheck ? 0 : erase_oob_size);
+	geo->size       = ptr_dev_info_t->device_size - (ECC_fcheck ? 0 : ecc_size);
+}
+
+/*
+ * Switch on-die ECC and the geometry that goes with it, as -d does at init.
+ * The enable bit is written from the cached register value and only when
+ * it changes, so a region table costs one SET FEATURE per boundary.
+ */
+void snand_ecc_mode(int on)
+{
+	struct SPI_NAND_FLASH_INFO_T *ptr_dev_info_t = _SPI_NAND_GET_DEVICE_INFO_PTR;
+	u8 die_num = 1, feature;
+	int i;
+
+	on = on ? 1 : 0;
+	if( on == ECC_fcheck )
+		return;
+
+	if( ((ptr_dev_info_t->feature) & SPI_NAND_FLASH_DIE_SELECT_1_HAVE) )
+		die_num = (ptr_dev_info_t->device_size / ptr_dev_info_t->page_size) >> 16;
+	else if( ((ptr_dev_info_t->feature) & SPI_NAND_FLASH_DIE_SELECT_2_HAVE) )
+		die_num = (ptr_dev_info_t->device_size / ptr_dev_info_t->page_size) >> 17;
+
+	_SPI_NAND_ENABLE_MANUAL_MODE();
+	for( i = 0; i < die_num && i < _SPI_NAND_ECC_DIES_MAX; i++ )
+	{
+		feature = on ? (_ecc_feature[i] | 0x10) : (_ecc_feature[i] & ~0x10);
+		if( feature == _ecc_feature[i] )
+			continue;
+		if( ((ptr_dev_info_t->feature) & SPI_NAND_FLASH_DIE_SELECT_1_HAVE) && (_die_id != i) )
+			spi_nand_protocol_die_select_1(_die_id = i);
+		else if( ((ptr_dev_info_t->feature) & SPI_NAND_FLASH_DIE_SELECT_2_HAVE) && (_die_id != i) )
+			spi_nand_protocol_die_select_2(_die_id = i);
+		spi_nand_protocol_set_feature(_ecc_feature_addr, feature);
+		_ecc_feature[i] = feature;
+	}
+
+	if( on )
+	{
+		ptr_dev_info_t->device_size -= ecc_size;
+		ptr_dev_info_t->erase_size  -= erase_oob_size;
+		ptr_dev_info_t->page_size   -= bmt_oob_size;
+		ptr_dev_info_t->oob_size     = bmt_oob_size;
+	}
+	else
+	{
+		ptr_dev_info_t->device_size += ecc_size;
+		ptr_dev_info_t->erase_size  += erase_oob_size;
+		ptr_dev_info_t->page_size   += bmt_oob_size;
+		ptr_dev_info_t->oob_size     = 0;
+	}
+	ECC_fcheck = on;
+	_ondie_ecc_flag = on;
+	bsize = ptr_dev_info_t->erase_size;
+	SPI_NAND_Flash_Clear_Read_Cache_Data();
+}
+
+/* Case insensitive substring match of a table name */
+static int snand_name_match(const char *name, const char *key)
+{
+	size_t i, n = strlen(key);
+
+	for (; *name; name++) {
+		for (i = 0; i < n && name[i] && tolower((unsigned char)name[i]) == tolower((unsigned char)key[i]); i++)
+			;
+		if (i == n)
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * Geometry of a table entry by (part of) its name, for offline work on dumps.
+ * Several matches are fine as long as they share the geometry.
+ */
+int snand_geometry(const char *name, struct snand_geometry *geo)
+{
+	const struct SPI_NAND_FLASH_INFO_T *p, *hit = NULL;
+	int i, exact, n = sizeof(spi_nand_flash_tables) / sizeof(struct SPI_NAND_FLASH_INFO_T);
+
+	for (i = 0; i < n && !hit; i++)
+		if (!strcasecmp(spi_nand_flash_tables[i].ptr_name, name))
+			hit = &spi_nand_flash_tables[i];
+	exact = hit != NULL;
+	for (i = 0; i < n && !exact; i++) {
+		p = &spi_nand_flash_tables[i];
+		if (!snand_name_match(p->ptr_name, name))
+			continue;
+		if (hit && (hit->device_size != p->device_size || hit->page_size != p->page_size ||
+		    hit->oob_size != p->oob_size || hit->erase_size != p->erase_size)) {
+			_SPI_NAND_PRINTF("SPI NAND %s matches %s and %s, be more specific.\n", name, hit->ptr_name, p->ptr_name);
+			return -1;
+		}
+		if (!hit)
+			hit = p;
+	}
+	if (!hit) {
+		_SPI_NAND_PRINTF("SPI NAND %s is not in the table, see -L.\n", name);
+		return -1;
+	}
+
+	geo->name       = hit->ptr_name;
+	geo->size       = hit->device_size;
+	geo->page_size  = hit->page_size;
+	geo->oob_size   = hit->oob_size;
+	geo->erase_size = hit->erase_size;
+	return 0;
+}
+
 void support_snand_list(void)
 {
 	int i;
@@ -4491,6 +5326,8 @@ void support_snand_list(void)
 	_SPI_NAND_PRINTF("SPI NAND Flash Support List:\n");
 	for ( i = 0; i < (sizeof(spi_nand_flash_tables)/sizeof(struct SPI_NAND_FLASH_INFO_T)); i++)
 	{
+		if ( spi_nand_flash_tables[i].feature & SPI_NAND_FLASH_SIM_ONLY )
+			continue;
 		_SPI_NAND_PRINTF("%03d. %s\n", i + 1, spi_nand_flash_tables[i].ptr_name);
 	}
 }
@@ -30,6 +30,7 @@
 /* INCLUDE FILE DECLARATIONS --------------------------------------------------------- */
 #include "types.h"
 #include "ch341a_spi.h"
+#include "flash_stat.h"
 
 /* MACRO DECLARATIONS ---------------------------------------------------------------- */
 #define SPI_NAND_FLASH_OOB_FREE_ENTRY_MAX	32
@@ -78,6 +79,7 @@ typedef enum{
 #define SPI_NAND_FLASH_PLANE_SELECT_HAVE	( 0x01 << 0 )
 #define SPI_NAND_FLASH_DIE_SELECT_1_HAVE	( 0x01 << 1 )
 #define SPI_NAND_FLASH_DIE_SELECT_2_HAVE	( 0x01 << 2 )
+#define SPI_NAND_FLASH_SIM_ONLY			( 0x01 << 3 )	/* model of the simulator, never real hardware */
 
 struct spi_nand_flash_oobfree{
 	unsigned long offset;
@@ -94,7 +96,7 @@ struct SPI_NAND_FLASH_INFO_T {
 	u8					dev_id;
 	u8					dev_id_2;
 	const char				*ptr_name;
-	u32					device_size;	/* Flash total Size */
+	u64					device_size;	/* Flash total Size */
 	u32					page_size;	/* Page Size */
 	u32					erase_size;	/* Block Size */
 	u32					oob_size;	/* Spare Area (OOB) Size */
@@ -103,6 +105,7 @@ struct SPI_NAND_FLASH_INFO_T {
 	SPI_NAND_FLASH_WRITE_SPEED_MODE_T	write_mode;
 	struct spi_nand_flash_ooblayout		*oob_free_layout;
 	u32					feature;
+	const struct chip_timing		*timing;	/* Datasheet tR/tPROG/tBERS */
 };
 
 struct nand_info {
@@ -163,9 +166,9 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Init( u32   rom_base );
 SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Get_Flash_Info( struct SPI_NAND_FLASH_INFO_T *ptr_rtn_into_t);
 
 /*------------------------------------------------------------------------------------
- * FUNCTION: SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u32    dst_addr,
- *                                                            u32    len,
- *                                                            u32    *ptr_rtn_len,
+ * FUNCTION: SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u64    dst_addr,
+ *                                                            u64    len,
+ *                                                            u64    *ptr_rtn_len,
  *                                                            u8*    ptr_buf      )
  * PURPOSE : To provide interface for Write N Bytes into SPI NAND Flash.
  * AUTHOR  :
@@ -184,9 +187,9 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Get_Flash_Info( struct SPI_NAND_FLASH_INFO_T
  *
  *------------------------------------------------------------------------------------
  */
-SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u32					dst_addr,
-                                                 u32					len,
-                                                 u32					*ptr_rtn_len,
+SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u64					dst_addr,
+                                                 u64					len,
+                                                 u64					*ptr_rtn_len,
                                                  u8					*ptr_buf,
                                                  SPI_NAND_FLASH_WRITE_SPEED_MODE_T	speed_mode );
 
@@ -213,16 +216,16 @@ SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Write_Nbyte( u32					dst_addr,
  *
  *------------------------------------------------------------------------------------
  */
-u32 SPI_NAND_Flash_Read_NByte( u32					addr,
-                               u32					len,
-                               u32					*retlen,
+u32 SPI_NAND_Flash_Read_NByte( u64					addr,
+                               u64					len,
+                               u64					*retlen,
                                u8					*buf,
                                SPI_NAND_FLASH_READ_SPEED_MODE_T		speed_mode,
                                SPI_NAND_FLASH_RTN_T			*status );
 
 /*------------------------------------------------------------------------------------
- * FUNCTION: SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Erase( u32  dst_addr,
- *                                                      u32  len      )
+ * FUNCTION: SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Erase( u64  dst_addr,
+ *                                                      u64  len      )
  * PURPOSE : To provide interface for Erase SPI NAND Flash.
  * AUTHOR  :
  * CALLED BY
@@ -239,8 +242,8 @@ u32 SPI_NAND_Flash_Read_NByte( u32					addr,
  *
  *------------------------------------------------------------------------------------
  */
-SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Erase( u32  dst_addr,
-                                           u32  len      );
+SPI_NAND_FLASH_RTN_T SPI_NAND_Flash_Erase( u64  dst_addr,
+                                           u64  len      );
 
 /*------------------------------------------------------------------------------------
  * FUNCTION: char SPI_NAND_Flash_Read_Byte( long     addr )
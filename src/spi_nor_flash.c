@@ -21,9 +21,10 @@
 #include <unistd.h>
 #include <stdbool.h>
 #include "spi_controller.h"
-#include "snorcmd_api.h"
+#include "flashcmd_api.h"
 #include "types.h"
 #include "timer.h"
+#include "flash_stat.h"
 
 #define min(a,b) (((a)<(b))?(a):(b))
 
@@ -33,6 +34,11 @@
 
 #define FLASH_PAGESIZE			256
 
+/* Cost of one more PP command in bus bytes: the WREN and PP transactions
+ * with their CS packets and address, plus the status poll round trip. */
+#define SNOR_PP_OVERHEAD		160
+#define SNOR_PP_MAX_SPANS		(FLASH_PAGESIZE / 2)
+
 /* Flash opcodes. */
 #define OPCODE_WREN			6	/* Write enable */
 #define OPCODE_WRDI			4	/* Write disable */
@@ -86,9 +92,34 @@ struct chip_info {
 	char		addr4b;
 	float vcc_min;
     float vcc_max;
+	const struct chip_timing *timing;	/* NULL - use vendor timing below */
+};
+
+/* Datasheet tPP (256 bytes) and tSE (64KB sector), typical and max, usec */
+static const struct snor_vendor_timing {
+	u8			id;
+	struct chip_timing	t;
+} snor_timings[] = {
+	{ 0xef, { 0, 0, 400,  3000, 150000, 2000000 } },	/* Winbond W25Q */
+	{ 0xc8, { 0, 0, 600,  2400, 150000, 1200000 } },	/* GigaDevice GD25Q */
+	{ 0xc2, { 0, 0, 600,  3000, 420000, 2000000 } },	/* Macronix MX25L */
+	{ 0x20, { 0, 0, 500,  5000, 700000, 3000000 } },	/* Micron/Numonyx N25Q, M25P, XMC */
+	{ 0x1c, { 0, 0, 800,  5000, 200000, 2000000 } },	/* EON EN25Q */
+	{ 0x68, { 0, 0, 600,  2400, 150000, 1200000 } },	/* Boya BY25Q */
+	{ 0x37, { 0, 0, 1500, 5000, 700000, 3000000 } },	/* AMIC A25L */
+	{ 0x5e, { 0, 0, 500,  3000, 200000, 2000000 } },	/* Zbit ZB25VQ */
+	{ 0x9d, { 0, 0, 200,  800,  300000, 1000000 } },	/* ISSI IS25LP */
+	{ 0x0b, { 0, 0, 500,  3000, 200000, 1200000 } },	/* XTX XT25F */
+	{ 0x85, { 0, 0, 1000, 3000, 12000,  40000 } },		/* Puya P25Q */
+	{ 0x01, { 0, 0, 250,  750,  130000, 650000 } },		/* Spansion S25FL */
+	{ 0xbf, { 0, 0, 1000, 1500, 18000,  25000 } },		/* SST SST25/26 */
+	{ 0x1f, { 0, 0, 400,  2500, 300000, 1000000 } },	/* Atmel/Adesto AT25 */
+	{ 0x00, { 0, 0, 700,  5000, 400000, 3000000 } }		/* others */
 };
 
 struct chip_info *spi_chip_info;
+static struct busy_timing snor_wait;	/* delay before polling WIP after program/erase */
+static unsigned long snor_polls;	/* busy polls seen by the last snor_wait_ready() */
 
 static int snor_wait_ready(int sleep_ms);
 static int snor_read_sr(u8 *val);
@@ -150,6 +181,7 @@ static int snor_wait_ready(int sleep_ms)
 		if ((snor_read_sr((u8 *)&sr)) < 0)
 			break;
 		else if (!(sr & (SR_WIP | SR_EPE | SR_WEL))) {
+			snor_polls = count;
 			return 0;
 		}
 		udelay(500);
@@ -159,6 +191,32 @@ static int snor_wait_ready(int sleep_ms)
 	return -1;
 }
 
+/*
+ * Wait for the end of a program or erase started at ``offset'', sleeping
+ * the learned busy time first and recording the busy polls.
+ */
+static int snor_wait_busy(int op, unsigned long offset, int sleep_ms)
+{
+	unsigned long pre = (op == STAT_OP_ERASE) ? snor_wait.erase_us : snor_wait.prog_us;
+
+	if (pre)
+		udelay(pre);
+	if (snor_wait_ready(sleep_ms))
+		return -1;
+	stat_record(op, offset / spi_chip_info->sector_size, snor_polls);
+	return 0;
+}
+
+static int snor_stat_poll(void)
+{
+	u8 sr;
+
+	/* one busy poll is a status read plus the poll interval */
+	snor_read_sr(&sr);
+	udelay(500);
+	return 0;
+}
+
 /*
  * read status register
  */
@@ -243,6 +301,8 @@ static int snor_4byte_mode(int enable)
  */
 static int snor_erase_sector(unsigned long offset)
 {
+	int ret;
+
 	snor_dbg("%s: offset:%x\n", __func__, offset);
 
 	/* Wait until finished previous write command. */
@@ -267,12 +327,12 @@ static int snor_erase_sector(unsigned long offset)
 
 	SPI_CONTROLLER_Chip_Select_High();
 
-	snor_wait_ready(950);
+	ret = snor_wait_busy(STAT_OP_ERASE, offset, 950);
 
 	if (spi_chip_info->addr4b)
 		snor_4byte_mode(0);
 
-	return 0;
+	return ret;
 }
 
 static int full_erase_chip(void)
@@ -809,7 +869,7 @@ struct chip_info *chip_prob(void)
 	return match;
 }
 
-long snor_init(void)
+long long snor_init(void)
 {
 	spi_chip_info = chip_prob();
 
@@ -817,20 +877,30 @@ long snor_init(void)
 		return -1;
 
 	bsize = spi_chip_info->sector_size;
+	if (!spi_chip_info->timing) {
+		const struct snor_vendor_timing *v = snor_timings;
 
-	return spi_chip_info->sector_size * spi_chip_info->n_sectors;
+		while (v->id && v->id != spi_chip_info->id)
+			v++;
+		spi_chip_info->timing = &v->t;
+	}
+	stat_load_timing(spi_chip_info->name, spi_chip_info->timing, &snor_wait);
+	stat_begin(spi_chip_info->name, spi_chip_info->n_sectors, snor_stat_poll, &snor_wait);
+
+	return (unsigned long long)spi_chip_info->sector_size * spi_chip_info->n_sectors;
 }
 
-int snor_erase(unsigned long offs, unsigned long len)
+int snor_erase(unsigned long long offs, unsigned long long len)
 {
-	unsigned long plen = len;
-	snor_dbg("%s: offs:%x len:%x\n", __func__, offs, len);
+	unsigned long long plen = len;
+	snor_dbg("%s: offs:%llx len:%llx\n", __func__, offs, len);
 
 	/* sanity checks */
 	if (len == 0)
 		return -1;
 
-	if(!offs && len == (spi_chip_info->sector_size * spi_chip_info->n_sectors))
+	/* characterization needs per sector timing, so no chip erase */
+	if(!offs && len == (spi_chip_info->sector_size * spi_chip_info->n_sectors) && !stat_enable)
 	{
 		printf("Please Wait......\n");
 		return full_erase_chip();
@@ -850,22 +920,24 @@ int snor_erase(unsigned long offs, unsigned long len)
 		len -= spi_chip_info->sector_size;
 		if( timer_progress() )
 		{
-			printf("\bErase %ld%% [%lu] of [%lu] bytes      ", 100 * (plen - len) / plen, plen - len, plen);
+			printf("\bErase %d%% [%llu] of [%llu] bytes      ", timer_percent(plen - len, plen), plen - len, plen);
 			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
 			fflush(stdout);
 		}
 	}
-	printf("Erase 100%% [%lu] of [%lu] bytes      \n", plen - len, plen);
+	printf("Erase 100%% [%llu] of [%llu] bytes      \n", plen - len, plen);
 	timer_end();
 
 	return 0;
 }
 
-int snor_read(unsigned char *buf, unsigned long from, unsigned long len)
+long long snor_read(unsigned char *buf, unsigned long long from, unsigned long long len)
 {
-	u32 read_addr, physical_read_addr, remain_len, data_offset;
+	u32 read_addr, physical_read_addr, remain_len, data_offset, chunk;
+	u8 cmd[5];
+	int n;
 
-	snor_dbg("%s: from:%x len:%x \n", __func__, from, len);
+	snor_dbg("%s: from:%llx len:%llx \n", __func__, from, len);
 
 	/* sanity checks */
 	if (len == 0)
@@ -881,70 +953,115 @@ int snor_read(unsigned char *buf, unsigned long from, unsigned long len)
 	read_addr = from;
 	remain_len = len;
 
+	if (spi_chip_info->addr4b)
+		snor_4byte_mode(1);
+
+	/* Sector reads are queued, the next one goes out while this one comes in */
 	while(remain_len > 0) {
 
 		physical_read_addr = read_addr;
 		data_offset = (physical_read_addr % (spi_chip_info->sector_size));
+		chunk = min(remain_len, spi_chip_info->sector_size - data_offset);
 
+		n = 0;
+		cmd[n++] = OPCODE_READ;
 		if (spi_chip_info->addr4b)
-			snor_4byte_mode(1);
+			cmd[n++] = (physical_read_addr >> 24) & 0xff;
+		cmd[n++] = (physical_read_addr >> 16) & 0xff;
+		cmd[n++] = (physical_read_addr >> 8) & 0xff;
+		cmd[n++] = physical_read_addr & 0xff;
 
-		SPI_CONTROLLER_Chip_Select_Low();
+		if (SPI_CONTROLLER_Submit_Xfer(cmd, n, &buf[len - remain_len], chunk) < 0) {
+			len = -1;
+			break;
+		}
+		remain_len -= chunk;
+		read_addr += chunk;
+		if( timer_progress() ) {
+			printf("\bRead %d%% [%llu] of [%llu] bytes      ", timer_percent(len - remain_len, len), len - remain_len, len);
+			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
+			fflush(stdout);
+		}
+	}
+	if (SPI_CONTROLLER_Wait_All() != SPI_CONTROLLER_RTN_NO_ERROR)
+		len = -1;
 
-		/* Set up the write data buffer. */
-		SPI_CONTROLLER_Write_One_Byte(OPCODE_READ);
+	if (spi_chip_info->addr4b)
+		snor_4byte_mode(0);
+	printf("Read 100%% [%llu] of [%llu] bytes      \n", len - remain_len, len);
+	timer_end();
 
-		if (spi_chip_info->addr4b)
-			SPI_CONTROLLER_Write_One_Byte((physical_read_addr >> 24) & 0xff);
-		SPI_CONTROLLER_Write_One_Byte((physical_read_addr >> 16) & 0xff);
-		SPI_CONTROLLER_Write_One_Byte((physical_read_addr >> 8) & 0xff);
-		SPI_CONTROLLER_Write_One_Byte(physical_read_addr & 0xff);
+	return len;
+}
 
-		if( (data_offset + remain_len) < spi_chip_info->sector_size )
-		{
-			if(SPI_CONTROLLER_Read_NByte(&buf[len - remain_len], remain_len, SPI_CONTROLLER_SPEED_SINGLE)) {
-				SPI_CONTROLLER_Chip_Select_High();
-				if (spi_chip_info->addr4b)
-					snor_4byte_mode(0);
-				len = -1;
-				break;
-			}
-			remain_len = 0;
+struct snor_span {
+	u32 off, len;
+};
+
+/*
+ * Program only clears bits, so 0xFF bytes need not cross the bus. The page
+ * is cut into the non-0xFF spans; two neighbours stay in one PP command
+ * unless the 0xFF gap between them is longer than the command overhead.
+ * The gaps are independent of each other, so deciding each one on its own
+ * gives the least bytes plus overhead for the page.
+ */
+static int snor_page_spans(const unsigned char *buf, u32 len, struct snor_span *span)
+{
+	u32 i = 0, start;
+	int n = 0;
+
+	while (i < len) {
+		while (i < len && buf[i] == 0xff)
+			i++;
+		if (i == len)
+			break;
+		start = i;
+		while (i < len && buf[i] != 0xff)
+			i++;
+		if (n && start - (span[n - 1].off + span[n - 1].len) <= SNOR_PP_OVERHEAD) {
+			span[n - 1].len = i - span[n - 1].off;
 		} else {
-			if(SPI_CONTROLLER_Read_NByte(&buf[len - remain_len], spi_chip_info->sector_size - data_offset, SPI_CONTROLLER_SPEED_SINGLE)) {
-				SPI_CONTROLLER_Chip_Select_High();
-				if (spi_chip_info->addr4b)
-					snor_4byte_mode(0);
-				len = -1;
-				break;
-			}
-			remain_len -= spi_chip_info->sector_size - data_offset;
-			read_addr += spi_chip_info->sector_size - data_offset;
-			if( timer_progress() ) {
-				printf("\bRead %ld%% [%lu] of [%lu] bytes      ", 100 * (len - remain_len) / len, len - remain_len, len);
-				printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
-				fflush(stdout);
-			}
+			span[n].off = start;
+			span[n].len = i - start;
+			n++;
 		}
+	}
+	return n;
+}
 
-		SPI_CONTROLLER_Chip_Select_High();
+/* One PP command queued as a single transaction, then wait for the program */
+static int snor_page_program(unsigned long to, unsigned char *buf, u32 len)
+{
+	u8 cmd[5 + FLASH_PAGESIZE];
+	int n = 0, h;
 
-		if (spi_chip_info->addr4b)
-			snor_4byte_mode(0);
-	}
-	printf("Read 100%% [%lu] of [%lu] bytes      \n", len - remain_len, len);
-	timer_end();
+	snor_write_enable();
+	snor_unprotect();
 
-	return len;
+	cmd[n++] = OPCODE_PP;
+	if (spi_chip_info->addr4b)
+		cmd[n++] = (to >> 24) & 0xff;
+	cmd[n++] = (to >> 16) & 0xff;
+	cmd[n++] = (to >> 8) & 0xff;
+	cmd[n++] = to & 0xff;
+	memcpy(&cmd[n], buf, len);
+
+	if ((h = SPI_CONTROLLER_Submit_Xfer(cmd, n + len, NULL, 0)) < 0 ||
+	    SPI_CONTROLLER_Wait_Xfer(h) != SPI_CONTROLLER_RTN_NO_ERROR)
+		return -1;
+
+	return snor_wait_busy(STAT_OP_PROGRAM, to, 3);
 }
 
-int snor_write(unsigned char *buf, unsigned long to, unsigned long len)
+long long snor_write(unsigned char *buf, unsigned long long to, unsigned long long len)
 {
+	struct snor_span span[SNOR_PP_MAX_SPANS];
 	u32 page_offset, page_size;
-	int rc = 0, retlen = 0;
-	unsigned long plen = len;
+	int rc = 0, i, nspan;
+	long long retlen = 0;
+	unsigned long long plen = len;
 
-	snor_dbg("%s: to:%x len:%x \n", __func__, to, len);
+	snor_dbg("%s: to:%llx len:%llx \n", __func__, to, len);
 
 	/* sanity checks */
 	if (len == 0)
@@ -970,33 +1087,21 @@ int snor_write(unsigned char *buf, unsigned long to, unsigned long len)
 	while (len > 0) {
 		page_size = min(len, FLASH_PAGESIZE - page_offset);
 		page_offset = 0;
-		/* write the next page to flash */
-
-		snor_wait_ready(3);
-		snor_write_enable();
-		snor_unprotect();
+		/* write the non-0xFF spans of the next page to flash */
 
-		SPI_CONTROLLER_Chip_Select_Low();
-		/* Set up the opcode in the write buffer. */
-		SPI_CONTROLLER_Write_One_Byte(OPCODE_PP);
-
-		if (spi_chip_info->addr4b)
-			SPI_CONTROLLER_Write_One_Byte((to >> 24) & 0xff);
-		SPI_CONTROLLER_Write_One_Byte((to >> 16) & 0xff);
-		SPI_CONTROLLER_Write_One_Byte((to >> 8) & 0xff);
-		SPI_CONTROLLER_Write_One_Byte(to & 0xff);
-
-		if(!SPI_CONTROLLER_Write_NByte(buf, page_size, SPI_CONTROLLER_SPEED_SINGLE))
-			rc = page_size;
-		else
-			rc = 1;
-
-		SPI_CONTROLLER_Chip_Select_High();
+		rc = page_size;
+		nspan = snor_page_spans(buf, page_size, span);
+		for (i = 0; i < nspan; i++) {
+			if (snor_page_program(to + span[i].off, buf + span[i].off, span[i].len) < 0) {
+				rc = 1;
+				break;
+			}
+		}
 
-		snor_dbg("%s: to:%x page_size:%x ret:%x\n", __func__, to, page_size, rc);
+		snor_dbg("%s: to:%llx page_size:%x ret:%x\n", __func__, to, page_size, rc);
 
 		if( timer_progress() ) {
-			printf("\bWritten %ld%% [%lu] of [%lu] bytes      ", 100 * (plen - len) / plen, plen - len, plen);
+			printf("\bWritten %d%% [%llu] of [%llu] bytes      ", timer_percent(plen - len, plen), plen - len, plen);
 			printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
 			fflush(stdout);
 		}
@@ -1021,12 +1126,26 @@ int snor_write(unsigned char *buf, unsigned long to, unsigned long len)
 
 	snor_write_disable();
 
-	printf("Written 100%% [%ld] of [%ld] bytes      \n", plen - len, plen);
+	printf("Written 100%% [%llu] of [%llu] bytes      \n", plen - len, plen);
 	timer_end();
 
 	return retlen;
 }
 
+void snor_info(struct flash_info *info)
+{
+	memset(info, 0, sizeof(*info));
+	info->name       = spi_chip_info->name;
+	info->page_size  = FLASH_PAGESIZE;
+	info->erase_size = spi_chip_info->sector_size;
+	info->skip_blank = 1;
+	info->reprogram  = 1;
+	info->read_op    = spi_chip_info->addr4b ? "READ 03h, 4-byte address" : "READ 03h";
+	info->prog_op    = spi_chip_info->addr4b ? "PP 02h, 4-byte address, 0xFF spans skipped" : "PP 02h, 0xFF spans skipped";
+	info->erase_op   = "SE D8h, full chip CE C7h";
+	info->timing     = spi_chip_info->timing;
+}
+
 void support_snor_list(void)
 {
 	int i;
@@ -0,0 +1,188 @@
+/*
+ * spi_speed.c
+ *
+ * SPI clock fallback ladder. The bus starts at the fastest setting, drops
+ * one step while ID reads or verify disagree, and the setting that held is
+ * kept per chip and fixture in the profile, so long leads and test clips
+ * run as fast as they reliably can.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spi_speed.h"
+#include "spi_controller.h"
+#include "ch341a_spi.h"
+#include "profile.h"
+#include "timer.h"
+
+#define SPI_SPEED_ID_READS	4
+#define SPI_SPEED_ID_LEN	5	/* NAND: dummy, MID, DID, DID; NOR: MID, DID, DID */
+#define SPI_SPEED_KEY		"spi_speed"
+#define SPI_SPEED_CHUNK		4096	/* re-read of a verify mismatch without a page size */
+
+int spi_speed = SPI_SPEED_MAX;
+int spi_speed_forced = -1;
+char *spi_fixture = NULL;
+
+static int spi_speed_active;	/* SPI flash is attached, not EEPROM */
+static int spi_speed_changed;	/* the ladder stepped down this run */
+static char spi_speed_chip_key[128];
+
+int spi_speed_parse(const char *s)
+{
+	char *end;
+	long v = strtol(s, &end, 10);
+
+	if (*s == 0 || *end != 0 || v < SPI_SPEED_MIN || v > SPI_SPEED_MAX) {
+		printf("SPI speed must be %d (slowest) to %d (fastest).\n", SPI_SPEED_MIN, SPI_SPEED_MAX);
+		return -1;
+	}
+	return v;
+}
+
+int spi_speed_set(int speed)
+{
+	if (config_stream(speed) < 0)
+		return -1;
+	spi_speed = speed;
+	return 0;
+}
+
+static int spi_speed_read_id(unsigned char *id)
+{
+	SPI_CONTROLLER_Chip_Select_Low();
+	SPI_CONTROLLER_Write_One_Byte(0x9F);
+	SPI_CONTROLLER_Read_NByte(id, SPI_SPEED_ID_LEN, SPI_CONTROLLER_SPEED_SINGLE);
+	return SPI_CONTROLLER_Chip_Select_High();
+}
+
+/* All reads equal; a missing chip reads the same 0xFF every time */
+static int spi_speed_id_stable(void)
+{
+	unsigned char first[SPI_SPEED_ID_LEN], id[SPI_SPEED_ID_LEN];
+	int i;
+
+	if (spi_speed_read_id(first) < 0)
+		return 0;
+	for (i = 1; i < SPI_SPEED_ID_READS; i++) {
+		if (spi_speed_read_id(id) < 0 || memcmp(first, id, sizeof(id)))
+			return 0;
+	}
+	return 1;
+}
+
+void spi_speed_probe(void)
+{
+	int start = spi_speed;
+
+	spi_speed_active = 1;
+	if (spi_speed_forced >= 0)
+		return;
+
+	while (!spi_speed_id_stable()) {
+		if (spi_speed == SPI_SPEED_MIN) {
+			printf("Chip ID is unstable at every SPI speed, check the wiring.\n");
+			spi_speed_set(start);
+			return;
+		}
+		printf("Chip ID is unstable at SPI speed %d, trying %d\n", spi_speed, spi_speed - 1);
+		spi_speed_set(spi_speed - 1);
+		spi_speed_changed = 1;
+	}
+}
+
+void spi_speed_chip(struct flash_cmd *cmd)
+{
+	struct flash_info info;
+	unsigned long v;
+
+	if (!spi_speed_active || !cmd->flash_info)
+		return;
+
+	cmd->flash_info(&info);
+	if (!spi_fixture)
+		spi_fixture = getenv("SNANDER_FIXTURE");
+	if (spi_fixture)
+		snprintf(spi_speed_chip_key, sizeof(spi_speed_chip_key), "%s@%s", info.name, spi_fixture);
+	else
+		snprintf(spi_speed_chip_key, sizeof(spi_speed_chip_key), "%s", info.name);
+
+	if (spi_speed_forced >= 0) {
+		printf("SPI speed: %d (set by user)\n", spi_speed);
+		return;
+	}
+	/* Verify failures learned earlier are below what the ID check sees */
+	if (!profile_get(spi_speed_chip_key, SPI_SPEED_KEY, &v) && (int)v < spi_speed)
+		spi_speed_set(v);
+	printf("SPI speed: %d of %d\n", spi_speed, SPI_SPEED_MAX);
+	if (spi_speed_changed)
+		spi_speed_save();
+}
+
+/* The same chunk read twice differs: the link, not the chip content */
+static int spi_speed_unstable(struct flash_cmd *cmd, const unsigned char *buf, unsigned long long addr,
+			      unsigned long long len, unsigned long long at)
+{
+	struct flash_info info;
+	unsigned long long from, n;
+	unsigned char *again;
+	int r;
+
+	memset(&info, 0, sizeof(info));
+	if (cmd->flash_info)
+		cmd->flash_info(&info);
+	if (!info.page_size)
+		info.page_size = SPI_SPEED_CHUNK;
+	/* at and the byte after it, the verify loop stops on either */
+	from = at - at % info.page_size;
+	n = (at + 1) - (at + 1) % info.page_size + info.page_size - from;
+	if (n > len - from)
+		n = len - from;
+	if (!(again = malloc(n)))
+		return 0;
+	timer_mute(1);
+	r = cmd->flash_read(again, addr + from, n) < 0 || memcmp(again, buf + from, n);
+	timer_mute(0);
+	free(again);
+	return r;
+}
+
+int spi_speed_retry(struct flash_cmd *cmd, const unsigned char *buf, unsigned long long addr,
+		    unsigned long long len, unsigned long long at)
+{
+	if (!spi_speed_active || spi_speed_forced >= 0 || spi_speed == SPI_SPEED_MIN)
+		return -1;
+	if (!spi_speed_unstable(cmd, buf, addr, len, at)) {
+		printf("Verify mismatch at 0x%016llX reads back the same at SPI speed %d, not retrying\n", addr + at, spi_speed);
+		return -1;
+	}
+	printf("Verify mismatch at SPI speed %d, retrying at %d\n", spi_speed, spi_speed - 1);
+	if (spi_speed_set(spi_speed - 1) < 0)
+		return -1;
+	spi_speed_changed = 1;
+	return 0;
+}
+
+void spi_speed_save(void)
+{
+	unsigned long v;
+
+	if (!spi_speed_active || !spi_speed_chip_key[0])
+		return;
+	if (!profile_get(spi_speed_chip_key, SPI_SPEED_KEY, &v) && (int)v == spi_speed)
+		return;
+	profile_set(spi_speed_chip_key, SPI_SPEED_KEY, spi_speed);
+}
+/* End of [spi_speed.c] package */
@@ -0,0 +1,49 @@
+/*
+ * spi_speed.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __SPI_SPEED_H__
+#define __SPI_SPEED_H__
+
+#include "flashcmd_api.h"
+
+/*
+ * SPI clock settings of the CH341A, the speed bits of the stream
+ * configuration (the same field selects 20K/100K/400K/750K for I2C).
+ */
+#define SPI_SPEED_MIN		0
+#define SPI_SPEED_MAX		3
+
+extern int spi_speed;		/* setting in use */
+extern int spi_speed_forced;	/* -1 - learned, else set by the user */
+extern char *spi_fixture;	/* adapter/clip name, speeds are kept per chip and fixture */
+
+int spi_speed_parse(const char *s);
+int spi_speed_set(int speed);
+
+/* Step down while repeated ID reads disagree, before the chip probe */
+void spi_speed_probe(void);
+/* Apply the setting learned for the detected chip */
+void spi_speed_chip(struct flash_cmd *cmd);
+/*
+ * Verify mismatch at byte at of the len bytes read from addr into buf: the
+ * chunk around it is read again and only when it comes back different the
+ * link is taken as marginal and the clock one step slower. Returns -1 when
+ * there is nothing left to try or the chip data is stable.
+ */
+int spi_speed_retry(struct flash_cmd *cmd, const unsigned char *buf, unsigned long long addr,
+		    unsigned long long len, unsigned long long at);
+/* Verify passed: remember the setting for the chip and fixture */
+void spi_speed_save(void);
+
+#endif /* __SPI_SPEED_H__ */
+/* End of [spi_speed.h] package */
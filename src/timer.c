@@ -15,6 +15,9 @@
 
 #include <stdio.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
 
 #include "timer.h"
 
@@ -54,4 +57,44 @@ int timer_progress(void)
 	}
 	return 0;
 }
+/* Progress in percent, done * 100 is computed in 64 bits */
+int timer_percent(unsigned long long done, unsigned long long total)
+{
+	if (!total || done >= total)
+		return 100;
+	return (int)(done * 100 / total);
+}
+
+unsigned long long timer_usec(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (unsigned long long)tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+/* The drivers report progress on stdout, callers that loop over them turn it off */
+void timer_mute(int on)
+{
+	static int saved = -1;
+	int fd;
+
+	fflush(stdout);
+	if (on && saved < 0) {
+#ifdef _WIN32
+		fd = open("NUL", O_WRONLY);
+#else
+		fd = open("/dev/null", O_WRONLY);
+#endif
+		if (fd < 0)
+			return;
+		saved = dup(STDOUT_FILENO);
+		dup2(fd, STDOUT_FILENO);
+		close(fd);
+	} else if (!on && saved >= 0) {
+		dup2(saved, STDOUT_FILENO);
+		close(saved);
+		saved = -1;
+	}
+}
 /* End of [timer.c] package */
@@ -18,6 +18,9 @@
 void timer_start(void);
 void timer_end(void);
 int timer_progress(void);
+int timer_percent(unsigned long long done, unsigned long long total);
+unsigned long long timer_usec(void);
+void timer_mute(int on);
 
 #endif /* __TIMER_H__ */
 /* End of [timer.h] package */
@@ -0,0 +1,451 @@
+/*
+ * wbcache.c
+ *
+ * Session write-back cache for many small scattered writes. Each write is
+ * kept in a buffer of its erase unit and an interval map of the dirty byte
+ * ranges, the chip is not touched. On commit every dirty unit is read once,
+ * merged with its ranges and written back with a single erase and program,
+ * in address order, so ten patches to one sector cost one erase. A NOR unit
+ * whose new data only clears bits is programmed without the erase, chips
+ * without an erase that write ranges get just the dirty ranges.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "wbcache.h"
+#include "timer.h"
+
+#define WBC_UNIT	4096	/* unit when the chip has no erase command */
+
+struct wbc_range {
+	unsigned long start, end;	/* unit offsets, end exclusive */
+};
+
+struct wbc_unit {
+	unsigned long long base;
+	unsigned char *data;		/* pending bytes, valid inside the ranges */
+	struct wbc_range *dirty;	/* sorted, neither overlapping nor touching */
+	int ndirty, size;
+};
+
+static struct {
+	struct flash_cmd *cmd;
+	struct flash_cmd orig;
+	unsigned long long flen;
+	unsigned long unit;
+	int erase, reprogram, whole_write;
+	struct wbc_unit *u;		/* sorted by base */
+	int nunits, size;
+	unsigned long writes;
+	unsigned long long bytes;
+} wbc;
+
+/* Index of the first unit that ends after addr */
+static int wbc_find(unsigned long long addr)
+{
+	int lo = 0, hi = wbc.nunits, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (wbc.u[mid].base + wbc.unit <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static struct wbc_unit *wbc_unit_get(unsigned long long base)
+{
+	struct wbc_unit *u;
+	int i = wbc_find(base);
+
+	if (i < wbc.nunits && wbc.u[i].base == base)
+		return &wbc.u[i];
+
+	if (wbc.nunits == wbc.size) {
+		u = realloc(wbc.u, (wbc.size ? wbc.size * 2 : 16) * sizeof(*u));
+		if (!u)
+			return NULL;
+		wbc.u = u;
+		wbc.size = wbc.size ? wbc.size * 2 : 16;
+	}
+	memmove(&wbc.u[i + 1], &wbc.u[i], (wbc.nunits - i) * sizeof(*u));
+	u = &wbc.u[i];
+	memset(u, 0, sizeof(*u));
+	u->base = base;
+	if (!(u->data = malloc(wbc.unit))) {
+		memmove(&wbc.u[i], &wbc.u[i + 1], (wbc.nunits - i) * sizeof(*u));
+		return NULL;
+	}
+	wbc.nunits++;
+	return u;
+}
+
+static void wbc_unit_free(struct wbc_unit *u)
+{
+	free(u->data);
+	free(u->dirty);
+}
+
+/* Add s..e to the ranges, merging the ones it overlaps or touches */
+static int wbc_range_add(struct wbc_unit *u, unsigned long s, unsigned long e)
+{
+	struct wbc_range *r;
+	int i, j;
+
+	for (i = 0; i < u->ndirty && u->dirty[i].end < s; i++)
+		;
+	for (j = i; j < u->ndirty && u->dirty[j].start <= e; j++) {
+		if (u->dirty[j].start < s)
+			s = u->dirty[j].start;
+		if (u->dirty[j].end > e)
+			e = u->dirty[j].end;
+	}
+
+	if (j == i) {
+		if (u->ndirty == u->size) {
+			r = realloc(u->dirty, (u->size ? u->size * 2 : 4) * sizeof(*r));
+			if (!r)
+				return -1;
+			u->dirty = r;
+			u->size = u->size ? u->size * 2 : 4;
+		}
+		memmove(&u->dirty[i + 1], &u->dirty[i], (u->ndirty - i) * sizeof(*r));
+		u->ndirty++;
+	} else {
+		memmove(&u->dirty[i + 1], &u->dirty[j], (u->ndirty - j) * sizeof(*r));
+		u->ndirty -= j - i - 1;
+	}
+	u->dirty[i].start = s;
+	u->dirty[i].end = e;
+	return 0;
+}
+
+static unsigned long wbc_unit_len(struct wbc_unit *u)
+{
+	return wbc.flen - u->base < wbc.unit ? wbc.flen - u->base : wbc.unit;
+}
+
+static long long wbc_read(unsigned char *buf, unsigned long long from, unsigned long long len)
+{
+	unsigned long long s, e;
+	struct wbc_unit *u;
+	long long ret;
+	int i, j;
+
+	if ((ret = wbc.orig.flash_read(buf, from, len)) < 0)
+		return ret;
+
+	/* Pending writes are laid over what the chip returns */
+	for (i = wbc_find(from); i < wbc.nunits && wbc.u[i].base < from + len; i++) {
+		u = &wbc.u[i];
+		for (j = 0; j < u->ndirty; j++) {
+			s = u->base + u->dirty[j].start;
+			e = u->base + u->dirty[j].end;
+			if (s < from)
+				s = from;
+			if (e > from + len)
+				e = from + len;
+			if (s < e)
+				memcpy(buf + (s - from), u->data + (s - u->base), e - s);
+		}
+	}
+	return ret;
+}
+
+static long long wbc_write(unsigned char *buf, unsigned long long to, unsigned long long len)
+{
+	unsigned long long pos, end = to + len;
+	unsigned long off, n;
+	struct wbc_unit *u;
+
+	if (to > wbc.flen || len > wbc.flen - to) {
+		printf("Write 0x%llX bytes at 0x%016llX is past the end of the chip\n", len, to);
+		return -1;
+	}
+
+	for (pos = to; pos < end; pos += n) {
+		off = pos % wbc.unit;
+		n = end - pos < wbc.unit - off ? end - pos : wbc.unit - off;
+		if (!(u = wbc_unit_get(pos - off)) || wbc_range_add(u, off, off + n) < 0) {
+			printf("Malloc failed for write cache.\n");
+			return -1;
+		}
+		memcpy(u->data + off, buf + (pos - to), n);
+	}
+	wbc.writes++;
+	wbc.bytes += len;
+	return len;
+}
+
+/* Pending writes into erased units are dropped, the erase goes to the chip */
+static int wbc_erase(unsigned long long offs, unsigned long long len)
+{
+	int i = wbc_find(offs), j;
+
+	for (j = i; j < wbc.nunits && wbc.u[j].base < offs + len; j++)
+		wbc_unit_free(&wbc.u[j]);
+	memmove(&wbc.u[i], &wbc.u[j], (wbc.nunits - j) * sizeof(*wbc.u));
+	wbc.nunits -= j - i;
+	return wbc.orig.flash_erase(offs, len);
+}
+
+int wbc_attach(struct flash_cmd *cmd, unsigned long long flen)
+{
+	struct flash_info info;
+
+	memset(&wbc, 0, sizeof(wbc));
+	memset(&info, 0, sizeof(info));
+	if (cmd->flash_info)
+		cmd->flash_info(&info);
+
+	wbc.unit = WBC_UNIT;
+	if (info.erase_size) {
+		wbc.unit = info.erase_size;
+		wbc.erase = 1;
+	} else if (info.page_size) {
+		wbc.unit = info.page_size;
+	}
+	/* Whole chip readers and writers program every word without an erase */
+	if (info.whole_chip || info.whole_write) {
+		wbc.unit = flen;
+		wbc.erase = 0;
+	}
+	wbc.reprogram = info.reprogram;
+	wbc.whole_write = info.whole_write;
+	wbc.flen = flen;
+	wbc.cmd = cmd;
+	wbc.orig = *cmd;
+
+	cmd->flash_read = wbc_read;
+	cmd->flash_write = wbc_write;
+	cmd->flash_erase = wbc_erase;
+	return 0;
+}
+
+void wbc_detach(void)
+{
+	int i;
+
+	if (!wbc.cmd)
+		return;
+	for (i = 0; i < wbc.nunits; i++)
+		wbc_unit_free(&wbc.u[i]);
+	free(wbc.u);
+	*wbc.cmd = wbc.orig;
+	memset(&wbc, 0, sizeof(wbc));
+}
+
+int wbc_commit(int verify, int dry)
+{
+	unsigned long n, i, b, ranges = 0, erased = 0, direct = 0, same = 0, bad = 0;
+	unsigned char *old, *new, *img;
+	unsigned long long start = timer_usec();
+	struct wbc_unit *u;
+	int k, j, need_erase, ret = -1;
+
+	old = malloc(wbc.unit);
+	new = malloc(wbc.unit);
+	img = malloc(wbc.unit);
+	if (!old || !new || !img) {
+		printf("Malloc failed for write cache.\n");
+		goto out;
+	}
+
+	if (dry)
+		printf("Unit  Address             Ranges  Bytes    Action\n");
+	for (k = 0; k < wbc.nunits; k++) {
+		u = &wbc.u[k];
+		n = wbc_unit_len(u);
+
+		/* Without an erase only the ranges are written, the unit is not read */
+		if (!wbc.erase && !wbc.whole_write) {
+			ranges += u->ndirty;
+			direct++;
+			for (j = 0, i = 0; j < u->ndirty; j++)
+				i += u->dirty[j].end - u->dirty[j].start;
+			if (dry) {
+				printf("%-5d 0x%016llX  %-7d %-8lu program ranges\n", k, u->base, u->ndirty, i);
+				continue;
+			}
+			timer_mute(1);
+			for (j = 0, b = 0; j < u->ndirty && !b; j++)
+				b = wbc.orig.flash_write(u->data + u->dirty[j].start, u->base + u->dirty[j].start,
+							 u->dirty[j].end - u->dirty[j].start) < 0;
+			if (!b && verify) {
+				b = wbc.orig.flash_read(old, u->base, n) < 0;
+				for (j = 0; j < u->ndirty && !b; j++)
+					b = memcmp(old + u->dirty[j].start, u->data + u->dirty[j].start,
+						   u->dirty[j].end - u->dirty[j].start) != 0;
+				if (b)
+					bad++;
+			}
+			timer_mute(0);
+			if (b) {
+				printf("Write back failed for unit at 0x%016llX\n", u->base);
+				goto out;
+			}
+			continue;
+		}
+
+		/* The unit is read once, here, and only if it has pending writes */
+		timer_mute(1);
+		j = wbc.orig.flash_read(old, u->base, n) < 0;
+		timer_mute(0);
+		if (j) {
+			printf("Read error at 0x%016llX\n", u->base);
+			goto out;
+		}
+		memcpy(new, old, n);
+		for (j = 0, i = 0; j < u->ndirty; j++) {
+			memcpy(new + u->dirty[j].start, u->data + u->dirty[j].start,
+			       u->dirty[j].end - u->dirty[j].start);
+			i += u->dirty[j].end - u->dirty[j].start;
+		}
+		ranges += u->ndirty;
+
+		if (!memcmp(old, new, n)) {
+			same++;
+			if (dry)
+				printf("%-5d 0x%016llX  %-7d %-8lu unchanged\n", k, u->base, u->ndirty, i);
+			continue;
+		}
+
+		/* 0 to 1 takes an erase, a NOR unit that only clears bits does not */
+		need_erase = wbc.erase;
+		if (need_erase && wbc.reprogram) {
+			for (b = 0, need_erase = 0; b < n && !need_erase; b++)
+				need_erase = (new[b] & ~old[b]) != 0;
+		}
+		if (dry) {
+			printf("%-5d 0x%016llX  %-7d %-8lu %s\n", k, u->base, u->ndirty, i,
+				need_erase ? "erase + program" : "program");
+			if (need_erase)
+				erased++;
+			else
+				direct++;
+			continue;
+		}
+
+		timer_mute(1);
+		if (need_erase) {
+			erased++;
+			j = wbc.orig.flash_erase(u->base, wbc.unit) != 0 ||
+			    wbc.orig.flash_write(new, u->base, n) < 0;
+		} else if (wbc.erase) {
+			/* Unchanged bytes stay 0xFF, the driver skips those spans */
+			direct++;
+			for (b = 0; b < n; b++)
+				img[b] = new[b] == old[b] ? 0xff : new[b];
+			j = wbc.orig.flash_write(img, u->base, n) < 0;
+		} else {
+			direct++;
+			j = wbc.orig.flash_write(new, u->base, n) < 0;
+		}
+		if (!j && verify) {
+			j = wbc.orig.flash_read(old, u->base, n) < 0 || memcmp(old, new, n);
+			if (j)
+				bad++;
+		}
+		timer_mute(0);
+		if (j) {
+			printf("Write back failed for unit at 0x%016llX\n", u->base);
+			goto out;
+		}
+	}
+
+	printf("Write cache: %lu writes, %llu bytes in %lu ranges over %d units of %lu bytes\n",
+		wbc.writes, wbc.bytes, ranges, wbc.nunits, wbc.unit);
+	printf("Write cache: %lu erase + program, %lu program only, %lu unchanged%s, %llu ms\n",
+		erased, direct, same, dry ? ", nothing written" : "", (timer_usec() - start) / 1000);
+	ret = 0;
+
+	/* Committed, later reads go to the chip */
+	for (k = 0; k < wbc.nunits && !dry; k++)
+		wbc_unit_free(&wbc.u[k]);
+	if (!dry)
+		wbc.nunits = 0;
+out:
+	if (bad)
+		printf("Verify failed for %lu units\n", bad);
+	free(old);
+	free(new);
+	free(img);
+	return ret;
+}
+
+static int wbc_hex(int c)
+{
+	return isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+}
+
+int wbc_patch(struct flash_cmd *cmd, const char *spec)
+{
+	unsigned long long addr;
+	unsigned char *buf = NULL;
+	long long len = 0;
+	const char *p;
+	char *end;
+	FILE *fp;
+	int ret = -1;
+
+	addr = strtoull(spec, &end, 0);
+	if (end == spec || (*end != '=' && *end != ':')) {
+		printf("Patch %s is not <addr>=<hex bytes> or <addr>:<file>\n", spec);
+		return -1;
+	}
+
+	if (*end == '=') {
+		p = end + 1;
+		if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+			p += 2;
+		len = strlen(p) / 2;
+		if (!len || strlen(p) % 2 || !(buf = malloc(len))) {
+			printf("Patch %s needs an even number of hex digits\n", spec);
+			goto out;
+		}
+		for (ret = 0; ret < len; ret++) {
+			if (!isxdigit((unsigned char)p[2 * ret]) || !isxdigit((unsigned char)p[2 * ret + 1])) {
+				printf("Patch %s needs an even number of hex digits\n", spec);
+				ret = -1;
+				goto out;
+			}
+			buf[ret] = wbc_hex((unsigned char)p[2 * ret]) << 4 | wbc_hex((unsigned char)p[2 * ret + 1]);
+		}
+	} else {
+		if (!(fp = fopen(end + 1, "rb"))) {
+			printf("Couldn't open file %s for reading.\n", end + 1);
+			goto out;
+		}
+		fseek(fp, 0, SEEK_END);
+		len = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+		if (len <= 0 || !(buf = malloc(len)) || fread(buf, 1, len, fp) != len) {
+			printf("Couldn't read file %s.\n", end + 1);
+			fclose(fp);
+			goto out;
+		}
+		fclose(fp);
+	}
+
+	printf("Patch addr = 0x%016llX, len = 0x%016llX\n", addr, len);
+	ret = cmd->flash_write(buf, addr, len) < 0 ? -1 : 0;
+out:
+	free(buf);
+	return ret;
+}
+/* End of [wbcache.c] package */
@@ -0,0 +1,38 @@
+/*
+ * wbcache.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __WBCACHE_H__
+#define __WBCACHE_H__
+
+#include "flashcmd_api.h"
+
+/*
+ * Route the write callbacks of cmd through the cache. Writes are kept in
+ * memory per erase unit until wbc_commit(), reads see them.
+ */
+int wbc_attach(struct flash_cmd *cmd, unsigned long long flen);
+
+/*
+ * Write the dirty units back in address order, one erase and program per
+ * unit. dry 1 only prints what would be done. Returns 0 or -1.
+ */
+int wbc_commit(int verify, int dry);
+
+/* Drop anything not committed and restore the callbacks of cmd */
+void wbc_detach(void);
+
+/* Write one <addr>:<file> or <addr>=<hex bytes> patch through the cache */
+int wbc_patch(struct flash_cmd *cmd, const char *spec);
+
+#endif /* __WBCACHE_H__ */
+/* End of [wbcache.h] package */